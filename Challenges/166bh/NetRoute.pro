@@ -1,3 +1,8 @@
 TEMPLATE = subdirs
 SUBDIRS = \
-    NetRoute/NetRoute.pro
+    core \
+    app
+
+core.file = NetRouteCore/NetRouteCore.pro
+app.file  = NetRoute/NetRoute.pro
+app.depends = core
@@ -4,26 +4,52 @@
 #
 #-------------------------------------------------
 
-QT       += core gui opengl
+QT       += core gui opengl network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++11
+
+# Let the routing kernels use whatever SIMD extensions the host supports
+unix: QMAKE_CXXFLAGS_RELEASE += -march=native
 TARGET = netroute
 TEMPLATE = app
 
+# Routing, loading and layout all live in the core library
+INCLUDEPATH += ../NetRouteCore
+DEPENDPATH  += ../NetRouteCore
+
+win32:CONFIG(release, debug|release) {
+    LIBS += -L$$OUT_PWD/../NetRouteCore/release -lnetroutecore
+    PRE_TARGETDEPS += $$OUT_PWD/../NetRouteCore/release/netroutecore.lib
+} else:win32:CONFIG(debug, debug|release) {
+    LIBS += -L$$OUT_PWD/../NetRouteCore/debug -lnetroutecore
+    PRE_TARGETDEPS += $$OUT_PWD/../NetRouteCore/debug/netroutecore.lib
+} else {
+    LIBS += -L$$OUT_PWD/../NetRouteCore -lnetroutecore
+    PRE_TARGETDEPS += $$OUT_PWD/../NetRouteCore/libnetroutecore.a
+}
+
 
 SOURCES += mainwindow.cpp \
     nodeitem.cpp \
     main.cpp \
     edgeitem.cpp \
-    controlsdockwidget.cpp
+    controlsdockwidget.cpp \
+    routingdaemon.cpp \
+    boostdijkstraengine.cpp \
+    batchcommand.cpp \
+    benchmarkcommand.cpp
 
 HEADERS  += mainwindow.h \
     nodeitem.h \
     graph.h \
     edgeitem.h \
-    controlsdockwidget.h
+    controlsdockwidget.h \
+    routingdaemon.h \
+    boostdijkstraengine.h \
+    batchcommand.h \
+    benchmarkcommand.h
 
 FORMS    += mainwindow.ui \
     controlsdockwidget.ui
@@ -0,0 +1,230 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <cstdio>
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include "batchcommand.h"
+
+BatchCommand::BatchCommand()
+{
+}
+
+int BatchCommand::run(const QStringList& arguments)
+{
+    int threads = 0;
+
+    for (int i = 0; i < arguments.size(); ++i) {
+        if (arguments[i] == "--threads" && i + 1 < arguments.size()) {
+            threads = qMax(arguments[++i].toInt(), 0);
+        } else if (!addInput(arguments[i])) {
+            return 2;
+        }
+    }
+    if (m_inputs.isEmpty()) {
+        m_inputs << "-";
+    }
+
+    ThreadPool pool(threads);
+    for (int i = 0; i < pool.threadCount(); ++i) {
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker));
+    }
+
+    // Reports are gathered a chunk at a time, then written out in order
+    QElapsedTimer            timer;
+    std::vector<std::string> reports;
+    std::vector<char>        routed;
+    int                      failures = 0;
+
+    timer.start();
+    for (int first = 0; first < m_inputs.size(); first += ChunkSize) {
+        int count = qMin<int>(ChunkSize, m_inputs.size() - first);
+
+        reports.assign(count, std::string());
+        routed.assign(count, 0);
+        pool.parallelFor(count,
+            [this, first, &reports, &routed] (int i, int thread) {
+                routed[i] = routeSpec(m_inputs[first + i], *m_workers[thread],
+                    reports[i]);
+            });
+
+        for (int i = 0; i < count; ++i) {
+            fputs(reports[i].c_str(), stdout);
+            failures += routed[i] ? 0 : 1;
+        }
+        fflush(stdout);
+    }
+
+    qint64 elapsed = timer.nsecsElapsed();
+    fprintf(stderr, "Routed %d of %d specifications in %.2f ms "
+        "(%.0f specs/s) on %d threads.\n",
+        m_inputs.size() - failures, m_inputs.size(), elapsed / 1e6,
+        m_inputs.size() * 1e9 / qMax<qint64>(elapsed, 1),
+        pool.threadCount());
+
+    return failures == 0 ? 0 : 1;
+}
+
+bool BatchCommand::addInput(const QString& path)
+{
+    if (path == "-") {
+        m_inputs << path;
+        return true;
+    }
+
+    QFileInfo info(path);
+    if (!info.exists()) {
+        fprintf(stderr, "Error: '%s' does not exist.\n",
+            path.toLocal8Bit().constData());
+        return false;
+    }
+
+    // Directories contribute every file in them, in name order
+    if (info.isDir()) {
+        QDir dir(path);
+        QStringList files = dir.entryList(QDir::Files, QDir::Name);
+        for (int i = 0; i < files.size(); ++i) {
+            m_inputs << dir.filePath(files[i]);
+        }
+    } else {
+        m_inputs << path;
+    }
+
+    return true;
+}
+
+bool BatchCommand::routeSpec(const QString& name, Worker& worker,
+    std::string& report)
+{
+    report += (name == "-" ? QString("<stdin>") : name).toUtf8().constData();
+    report += ":\n";
+
+    if (!readSpec(name, worker, report)) {
+        return false;
+    }
+
+    // The same checks, in the same order, as MainWindow::buildNetwork()
+    NetworkModel& network = worker.network;
+    int           loaded  = network.load(worker.parser);
+    postProblems(report, network.loadResult());
+    if (loaded < 0) {
+        return false;
+    }
+
+    // Malformed cells and start/end lines stop routing, as in the explorer
+    if (loaded > 0) {
+        post(report, "Error", "Routing skipped step due to warnings.");
+        return false;
+    }
+
+    // The first pair is the route the explorer would draw
+    const SymbolTable&  names  = network.names();
+    int                 source = network.queries()[0].source;
+    int                 target = network.queries()[0].target;
+    if (!network.route(source, target, NetworkModel::RouteOptions())) {
+        postProblems(report, network.routeResult());
+        post(report, "Error", "Route has not been built.");
+        return false;
+    }
+
+    post(report, nullptr, QString("Total route cost: %1")
+        .arg(network.routeDistance()));
+    post(report, nullptr, QString("Route taken:      %1")
+        .arg(QString::fromStdString(NetworkModel::routeText(network.graph(),
+            names, source, network.routePath()))));
+
+    // ...and the rest are reported as a batch
+    if (network.queries().size() > 1) {
+        network.routeBatch();
+
+        const BatchRouter& batch = network.batch();
+        post(report, nullptr, QString("Batch of %1 queries (start -> end: "
+            "cost, route):")
+                .arg(batch.queryCount()));
+        for (int i = 0; i < batch.queryCount(); ++i) {
+            const RouteQuery&  query  = batch.query(i);
+            const RouteResult& result = batch.result(i);
+
+            QString entry = QString("%1 -> %2: ")
+                .arg(QString::fromStdString(names.name(query.source)))
+                .arg(QString::fromStdString(names.name(query.target)));
+            if (result.distance == Unreachable) {
+                entry += "unreachable";
+            } else {
+                entry += QString("%1, %2")
+                    .arg(result.distance)
+                    .arg(QString::fromStdString(NetworkModel::routeText(
+                        network.graph(), names, query.source, result.path)));
+            }
+            post(report, nullptr, entry);
+        }
+    }
+
+    return true;
+}
+
+bool BatchCommand::readSpec(const QString& name, Worker& worker,
+    std::string& report)
+{
+    QFile file;
+    if (name == "-") {
+        file.open(stdin, QIODevice::ReadOnly);
+    } else {
+        file.setFileName(name);
+        file.open(QIODevice::ReadOnly);
+    }
+    if (!file.isOpen()) {
+        post(report, "Error", QString("Cannot open '%1': %2")
+            .arg(name)
+            .arg(file.errorString()));
+        return false;
+    }
+
+    // Files are parsed in place, as in the explorer; pipes have to be read
+    qint64 size = file.isSequential() ? 0 : file.size();
+    uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (data) {
+        worker.parser.parse(reinterpret_cast<const char*>(data),
+            static_cast<size_t>(size));
+        file.unmap(data);
+    } else {
+        QByteArray bytes = file.readAll();
+        worker.parser.parse(bytes.constData(), bytes.size());
+    }
+
+    return true;
+}
+
+void BatchCommand::post(std::string& report, const char* leader,
+    const QString& msg)
+{
+    // The report itself goes out bare; problems keep their transcript leader
+    if (leader) {
+        report += leader;
+        report += ": ";
+    }
+    report += msg.toUtf8().constData();
+    report += '\n';
+}
+
+void BatchCommand::postProblems(std::string& report,
+    const NetworkModel::StageResult& stage)
+{
+    // Progress notes are for the explorer's transcript only
+    for (size_t i = 0; i < stage.messages.size(); ++i) {
+        const NetworkModel::Message& message = stage.messages[i];
+        if (message.type == NetworkModel::WarningMessage ||
+                message.type == NetworkModel::ErrorMessage) {
+            post(report, message.type == NetworkModel::ErrorMessage ?
+                "Error" : "Warning", QString::fromStdString(message.text));
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef BATCHCOMMAND_H
+#define BATCHCOMMAND_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "networkmodel.h"
+#include "specparser.h"
+#include "threadpool.h"
+
+
+// Headless mode, run as
+//
+//     netroute --batch [--threads N] [file | directory | -]...
+//
+// Every specification named, every file in a directory named, or standard
+// input if there are none, is parsed and routed with no widgets and no event
+// loop.  The report is printed in the same words generateRouteReport() uses,
+// routes included (see NetworkModel::routeText()), one block per
+// specification and in the order they were given, while the specifications
+// themselves are spread across a thread pool.
+class BatchCommand
+{
+public:
+    BatchCommand();
+
+    // Returns the exit status: 0 if every specification was routed
+    int run(const QStringList& arguments);
+
+private:
+    // Per-thread scratch; every specification is built into these afresh.
+    // The model cannot be moved, so workers are held by pointer.
+    struct Worker
+    {
+        SpecParser      parser;
+        NetworkModel    network;
+    };
+
+    // Specifications routed between two writes to the output
+    enum { ChunkSize = 256 };
+
+    bool addInput(const QString& path);
+    bool routeSpec(const QString& name, Worker& worker, std::string& report);
+    bool readSpec(const QString& name, Worker& worker, std::string& report);
+
+    static void post(std::string& report, const char* leader,
+        const QString& msg);
+    static void postProblems(std::string& report,
+        const NetworkModel::StageResult& stage);
+
+private:
+    QStringList                             m_inputs;
+    std::vector<std::unique_ptr<Worker> >   m_workers;
+};
+
+
+#endif  /* !BATCHCOMMAND_H */
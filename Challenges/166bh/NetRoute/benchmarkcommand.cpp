@@ -0,0 +1,242 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include <QtCore/QElapsedTimer>
+
+#include "benchmarkcommand.h"
+#include "deltasteppingengine.h"
+#include "dijkstraengine.h"
+#include "specparser.h"
+#include "threadpool.h"
+
+// Defaults: a network about the size of a metropolitan road map
+static const int DefaultNodeCount = 100000;
+static const int DefaultLinkCount = 1000000;
+static const int DefaultSearches  = 20;
+
+// ...and a specification of a million cells, parsed this many times over
+static const int DefaultMatrixSize = 1000;
+static const int ParseRepeats      = 10;
+
+// Links cost 1 to this
+static const int MaxLinkWeight = 100;
+
+
+BenchmarkCommand::BenchmarkCommand()
+    : m_threads(0)
+    , m_nodeCount(DefaultNodeCount)
+    , m_linkCount(DefaultLinkCount)
+    , m_searches(DefaultSearches)
+    , m_matrixSize(DefaultMatrixSize)
+    , m_seed(1)
+{
+}
+
+int BenchmarkCommand::run(const QStringList& arguments)
+{
+    if (!parseArguments(arguments)) {
+        return 2;
+    }
+
+    QElapsedTimer            timer;
+    std::vector<RoutingEdge> edges;
+    RoutingGraph             graph;
+
+    timer.start();
+    generateNetwork(m_nodeCount, m_linkCount, m_seed, edges);
+    graph.build(m_nodeCount, edges);
+    printf("Generated %d nodes and %d links in %.1f ms (seed %u).\n",
+        graph.vertexCount(), graph.edgeCount(), timer.nsecsElapsed() / 1e6,
+        m_seed);
+
+    benchmarkRouting(graph);
+
+    std::string text;
+    timer.start();
+    generateSpec(m_matrixSize, m_seed, text);
+    printf("Generated a %d-node specification of %u bytes in %.1f ms.\n",
+        m_matrixSize, static_cast<unsigned>(text.size()),
+        timer.nsecsElapsed() / 1e6);
+
+    benchmarkParsing(text);
+    return 0;
+}
+
+void BenchmarkCommand::generateNetwork(int nodeCount, int linkCount,
+    unsigned seed, std::vector<RoutingEdge>& edges)
+{
+    std::mt19937                       random(seed);
+    std::uniform_int_distribution<int> node(0, nodeCount - 1);
+    std::uniform_int_distribution<int> weight(1, MaxLinkWeight);
+
+    edges.clear();
+    edges.reserve(std::max(linkCount, nodeCount));
+
+    // The ring keeps every node reachable from every other
+    for (int v = 0; v < nodeCount && nodeCount > 1; ++v) {
+        edges.push_back(RoutingEdge(v, (v + 1) % nodeCount, weight(random)));
+    }
+    while (static_cast<int>(edges.size()) < linkCount) {
+        int source = node(random);
+        int target = node(random);
+        if (source != target) {
+            edges.push_back(RoutingEdge(source, target, weight(random)));
+        }
+    }
+
+    // Rows in order, as a parsed specification would give them
+    std::stable_sort(edges.begin(), edges.end(),
+        [] (const RoutingEdge& a, const RoutingEdge& b) {
+            return a.source < b.source;
+        });
+}
+
+void BenchmarkCommand::generateSpec(int nodeCount, unsigned seed,
+    std::string& text)
+{
+    std::mt19937                       random(seed);
+    std::uniform_int_distribution<int> weight(1, MaxLinkWeight);
+    char                               cell[16];
+
+    text = std::to_string(nodeCount) + "\n";
+    for (int row = 0; row < nodeCount; ++row) {
+        for (int column = 0; column < nodeCount; ++column) {
+            // A coin flip per cell, from the top bit of the generator
+            bool linked = (random() & 0x80000000u) != 0;
+            snprintf(cell, sizeof cell, column == 0 ? "%d" : ",%d",
+                linked ? weight(random) : -1);
+            text += cell;
+        }
+        text += '\n';
+    }
+    text += "A B\n";
+}
+
+bool BenchmarkCommand::parseArguments(const QStringList& arguments)
+{
+    for (int i = 0; i < arguments.size(); ++i) {
+        bool ok    = i + 1 < arguments.size();
+        int  value = ok ? arguments[i + 1].toInt(&ok) : 0;
+
+        if (ok && arguments[i] == "--threads" && value >= 0) {
+            m_threads = value;
+        } else if (ok && arguments[i] == "--nodes" && value > 0) {
+            m_nodeCount = value;
+        } else if (ok && arguments[i] == "--links" && value >= 0) {
+            m_linkCount = value;
+        } else if (ok && arguments[i] == "--searches" && value > 0) {
+            m_searches = value;
+        } else if (ok && arguments[i] == "--matrix" && value > 1) {
+            m_matrixSize = value;
+        } else if (ok && arguments[i] == "--seed") {
+            m_seed = static_cast<unsigned>(value);
+        } else {
+            fprintf(stderr, "Error: unexpected argument '%s'.\n",
+                arguments[i].toLocal8Bit().constData());
+            return false;
+        }
+        ++i;
+    }
+
+    if (m_nodeCount < 2 && m_linkCount > 0) {
+        fprintf(stderr, "Error: links need at least two nodes.\n");
+        return false;
+    }
+    return true;
+}
+
+void BenchmarkCommand::benchmarkRouting(const RoutingGraph& graph)
+{
+    // Every engine searches from the same sources
+    std::mt19937                       random(m_seed);
+    std::uniform_int_distribution<int> node(0, graph.vertexCount() - 1);
+    std::vector<int>                   sources;
+    for (int i = 0; i < m_searches; ++i) {
+        sources.push_back(node(random));
+    }
+
+    QElapsedTimer  timer;
+    DijkstraEngine dijkstra(&graph);
+
+    timer.start();
+    for (size_t i = 0; i < sources.size(); ++i) {
+        dijkstra.route(sources[i]);
+    }
+    printf("DijkstraEngine: %.2f ms per search.\n",
+        timer.nsecsElapsed() / 1e6 / m_searches);
+
+    // The first search of each pool sizes its buffers, so it is not timed
+    DeltaSteppingEngine deltaStepping(&graph);
+    double              oneThread = 0.0;
+
+    printf("Threads  DeltaSteppingEngine  Speedup\n");
+    std::vector<int> counts = threadCounts();
+    for (size_t c = 0; c < counts.size(); ++c) {
+        ThreadPool pool(counts[c]);
+        deltaStepping.route(sources[0], -1, &pool);
+
+        timer.start();
+        for (size_t i = 0; i < sources.size(); ++i) {
+            deltaStepping.route(sources[i], -1, &pool);
+        }
+        double perSearch = timer.nsecsElapsed() / 1e6 / m_searches;
+        if (c == 0) {
+            oneThread = perSearch;
+        }
+
+        printf("%7d  %16.2f ms  %6.2fx\n", pool.threadCount(), perSearch,
+            oneThread / perSearch);
+    }
+}
+
+void BenchmarkCommand::benchmarkParsing(const std::string& text)
+{
+    SpecParser    spec;
+    QElapsedTimer timer;
+    double        oneThread = 0.0;
+
+    spec.parse(text.data(), text.size());
+    printf("SpecParser found %d links.\n",
+        static_cast<int>(spec.edges().size()));
+
+    // As in benchmarkRouting(), each pool's first parse is not timed
+    printf("Threads  SpecParser      MB/s  Speedup\n");
+    std::vector<int> counts = threadCounts();
+    for (size_t c = 0; c < counts.size(); ++c) {
+        ThreadPool pool(counts[c]);
+        spec.parse(text.data(), text.size(), &pool);
+
+        timer.start();
+        for (int i = 0; i < ParseRepeats; ++i) {
+            spec.parse(text.data(), text.size(), &pool);
+        }
+        double perParse = timer.nsecsElapsed() / 1e6 / ParseRepeats;
+        if (c == 0) {
+            oneThread = perParse;
+        }
+
+        printf("%7d  %7.2f ms  %8.1f  %6.2fx\n", pool.threadCount(),
+            perParse, text.size() / 1e3 / perParse, oneThread / perParse);
+    }
+}
+
+std::vector<int> BenchmarkCommand::threadCounts() const
+{
+    int most = m_threads > 0 ? m_threads : ThreadPool::idealThreadCount();
+
+    std::vector<int> counts;
+    for (int threads = 1; threads < most; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(most);
+
+    return counts;
+}
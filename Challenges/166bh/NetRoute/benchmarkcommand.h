@@ -0,0 +1,67 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef BENCHMARKCOMMAND_H
+#define BENCHMARKCOMMAND_H
+
+#include <string>
+#include <vector>
+
+#include <QtCore/QStringList>
+
+#include "routinggraph.h"
+
+
+// Headless scaling benchmark, run as
+//
+//     netroute --benchmark [--threads N] [--nodes V] [--links E]
+//                          [--searches S] [--matrix M] [--seed SEED]
+//
+// A random network is generated: a ring through every node, so that each
+// search covers the whole graph, plus random links up to the total asked
+// for (a million by default).  Full searches are timed with DijkstraEngine
+// and then with DeltaSteppingEngine on 1, 2, 4... up to N threads, and the
+// time per search and the speedup over one thread are printed as a table.
+//
+// Then a specification of M nodes (a million matrix cells by default) is
+// written out in memory and parsed by SpecParser on the same thread counts.
+// The same seed always generates the same networks and the same sources.
+class BenchmarkCommand
+{
+public:
+    BenchmarkCommand();
+
+    // Returns the exit status: 0 unless the arguments made no sense
+    int run(const QStringList& arguments);
+
+    // Ring plus random links of weight 1 to 100, in row-major order
+    static void generateNetwork(int nodeCount, int linkCount, unsigned seed,
+        std::vector<RoutingEdge>& edges);
+
+    // Specification text: about half the cells hold a link, the rest -1,
+    // and one start/end line
+    static void generateSpec(int nodeCount, unsigned seed, std::string& text);
+
+private:
+    bool parseArguments(const QStringList& arguments);
+    void benchmarkRouting(const RoutingGraph& graph);
+    void benchmarkParsing(const std::string& text);
+
+    // 1, 2, 4... and finally the largest count asked for
+    std::vector<int> threadCounts() const;
+
+private:
+    int         m_threads;
+    int         m_nodeCount;
+    int         m_linkCount;
+    int         m_searches;
+    int         m_matrixSize;
+    unsigned    m_seed;
+};
+
+
+#endif  /* !BENCHMARKCOMMAND_H */
@@ -0,0 +1,99 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+
+#include "boostdijkstraengine.h"
+
+// Records the search tree and bails out at the target
+class BoostDijkstraEngine::Visitor : public boost::default_dijkstra_visitor
+{
+public:
+    Visitor(BoostDijkstraEngine* engine, int target)
+        : m_engine(engine)
+        , m_target(target)
+    {
+    }
+
+    void examine_vertex(DigraphVertex v, const Digraph&)
+    {
+        m_engine->m_settled += 1;
+        if (static_cast<int>(v) == m_target) {
+            throw TargetSettled();
+        }
+    }
+
+    void edge_relaxed(Digraph::edge_descriptor e, const Digraph& g)
+    {
+        int v = static_cast<int>(boost::target(e, g));
+
+        m_engine->m_predecessor[v]     = static_cast<int>(boost::source(e, g));
+        m_engine->m_predecessorEdge[v] = g[e].item->data(EdgeIndexKey).toInt();
+    }
+
+private:
+    BoostDijkstraEngine*    m_engine;
+    int                     m_target;
+};
+
+
+BoostDijkstraEngine::BoostDijkstraEngine(const Digraph* graph /* = nullptr */)
+    : m_graph(graph)
+    , m_settled(0)
+{
+}
+
+bool BoostDijkstraEngine::route(int source, int target /* = -1 */)
+{
+    int n = static_cast<int>(boost::num_vertices(*m_graph));
+
+    // Boost initialises every distance itself
+    m_distance.resize(n);
+    m_predecessor.assign(n, -1);
+    m_predecessorEdge.assign(n, -1);
+    m_settled = 0;
+
+    try {
+        boost::dijkstra_shortest_paths(*m_graph,
+            boost::vertex(source, *m_graph),
+            boost::weight_map(boost::get(&EdgeProperties::weight, *m_graph))
+                .distance_map(m_distance.data())
+                .distance_inf(std::numeric_limits<double>::infinity())
+                .visitor(Visitor(this, target)));
+    } catch (const TargetSettled&) {
+        return true;
+    }
+
+    return target < 0;
+}
+
+Distance BoostDijkstraEngine::distance(int v) const
+{
+    // Boost leaves anything it never reached at infinity
+    double dist = m_distance[v];
+    if (dist == std::numeric_limits<double>::infinity() ||
+            dist >= static_cast<double>(Unreachable)) {
+        return Unreachable;
+    }
+    return static_cast<Distance>(dist);
+}
+
+std::vector<int> BoostDijkstraEngine::path(int target) const
+{
+    std::vector<int> edges;
+
+    // Walk backwards from the target to the source, then flip it over
+    for (int v = target; m_predecessor[v] >= 0; v = m_predecessor[v]) {
+        edges.push_back(m_predecessorEdge[v]);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return edges;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef BOOSTDIJKSTRAENGINE_H
+#define BOOSTDIJKSTRAENGINE_H
+
+#include <vector>
+
+#include "graph.h"
+#include "routinggraph.h"
+
+
+// Dijkstra from Boost.Graph, run straight on the explorer's Digraph using
+// EdgeProperties::weight.  It is mostly here as a reference point for the
+// hand-written engines, and the explorer draws the route it finds: a
+// visitor counts settled nodes, records the edge each node was last reached
+// through, and stops the search once the target is settled.
+//
+// Boost offers no other way out of dijkstra_shortest_paths than throwing
+// from the visitor, so route() catches that itself and nothing escapes.
+class BoostDijkstraEngine
+{
+public:
+    BoostDijkstraEngine(const Digraph* graph = nullptr);
+
+    const Digraph* graph() const { return m_graph; }
+    void setGraph(const Digraph* graph) { m_graph = graph; }
+
+    // Searches from source, stopping as soon as target is settled.  Passing
+    // a negative target builds the complete shortest-path tree.  Returns
+    // whether target (or, for a full tree, anything) was reached.
+    bool route(int source, int target = -1);
+
+    Distance distance(int v) const;
+    int  predecessorEdge(int v) const { return m_predecessorEdge[v]; }
+    bool isReached(int v) const { return distance(v) != Unreachable; }
+
+    // Edge indices of the path found to target, ordered start to end
+    std::vector<int> path(int target) const;
+
+    int settledCount() const { return m_settled; }
+
+private:
+    class Visitor;
+    struct TargetSettled {};
+
+private:
+    const Digraph*          m_graph;
+
+    std::vector<double>     m_distance;
+    std::vector<int>        m_predecessor;
+    std::vector<int>        m_predecessorEdge;
+    int                     m_settled;
+};
+
+
+#endif  /* !BOOSTDIJKSTRAENGINE_H */
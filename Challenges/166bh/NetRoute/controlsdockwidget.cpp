@@ -5,9 +5,12 @@
  * file at the root of this repository.
  */
 
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
 #include <QtCore/QMimeData>
 #include <QtGui/QClipboard>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QFileDialog>
 
 #include "controlsdockwidget.h"
 #include "mainwindow.h"
@@ -38,17 +41,31 @@ ControlsDockWidget::ControlsDockWidget(MainWindow* parent) :
         &MainWindow::applyRandomLayout);
     connect(m_ui.springLayoutButton, &QPushButton::clicked, parent,
         &MainWindow::applySpringLayout);
+    connect(m_ui.forceLayoutButton, &QPushButton::clicked, parent,
+        &MainWindow::applyForceLayout);
+    connect(m_ui.multilevelLayoutButton, &QPushButton::clicked, parent,
+        &MainWindow::applyMultilevelLayout);
     connect(m_ui.pasteAndRouteButton, &QPushButton::clicked, this,
         &ControlsDockWidget::pasteAndRouteClicked);
     connect(m_ui.routeButton, &QPushButton::clicked, this,
         &ControlsDockWidget::routeClicked);
+    connect(m_ui.openSpecButton, &QPushButton::clicked, this,
+        &ControlsDockWidget::openSpecClicked);
+    connect(m_ui.convertSpecButton, &QPushButton::clicked, this,
+        &ControlsDockWidget::convertSpecClicked);
     connect(m_ui.clearSpecButton, &QPushButton::clicked, [this] () {
         m_ui.problemSpecEdit->clear();
     });
     connect(m_ui.clearNetworkButton, &QPushButton::clicked, parent,
         &MainWindow::clearNetwork);
+    connect(m_ui.saveSessionButton, &QPushButton::clicked, this,
+        &ControlsDockWidget::saveSessionClicked);
+    connect(m_ui.routingTableButton, &QPushButton::clicked, parent,
+        &MainWindow::buildRoutingTable);
     connect(m_ui.generateReportButton, &QPushButton::clicked, parent,
         &MainWindow::generateRouteReport);
+    connect(m_ui.applyLinkButton, &QPushButton::clicked, parent,
+        &MainWindow::editLink);
     connect(m_ui.exitButton, &QPushButton::clicked, qApp, &QApplication::quit);
 
     // Monitor the clipboard so we can only enable paste when there's text data
@@ -58,6 +75,12 @@ ControlsDockWidget::ControlsDockWidget(MainWindow* parent) :
         &ControlsDockWidget::problemSpecChanged);
     connect(this, &ControlsDockWidget::parseRequested, parent,
         &MainWindow::parseAndRouteNetwork);
+    connect(this, &ControlsDockWidget::loadRequested, parent,
+        &MainWindow::loadAndRouteNetwork);
+    connect(this, &ControlsDockWidget::convertRequested, parent,
+        &MainWindow::convertNetworkFile);
+    connect(this, &ControlsDockWidget::saveRequested, parent,
+        &MainWindow::saveSession);
 
     // Finally, check the clipboard for data
     clipboardDataChanged();
@@ -91,6 +114,8 @@ void ControlsDockWidget::enableGraphLayoutOptions(bool enable)
     m_graphDisplayEnabled = enable;
     m_ui.randomLayoutButton->setEnabled(enable);
     m_ui.springLayoutButton->setEnabled(enable);
+    m_ui.forceLayoutButton->setEnabled(enable);
+    m_ui.multilevelLayoutButton->setEnabled(enable);
 }
 
 bool ControlsDockWidget::isClearNetworkEnabled() const
@@ -100,7 +125,19 @@ bool ControlsDockWidget::isClearNetworkEnabled() const
 
 void ControlsDockWidget::enableClearNetwork(bool enable)
 {
+    // Any network that can be cleared can also be saved
     m_ui.clearNetworkButton->setEnabled(enable);
+    m_ui.saveSessionButton->setEnabled(enable);
+}
+
+bool ControlsDockWidget::isRoutingTableEnabled() const
+{
+    return m_ui.routingTableButton->isEnabled();
+}
+
+void ControlsDockWidget::enableRoutingTable(bool enable)
+{
+    m_ui.routingTableButton->setEnabled(enable);
 }
 
 bool ControlsDockWidget::isGenerateReportEnabled() const
@@ -113,6 +150,19 @@ void ControlsDockWidget::enableGenerateReport(bool enable)
     m_ui.generateReportButton->setEnabled(enable);
 }
 
+bool ControlsDockWidget::isLinkEditingEnabled() const
+{
+    return m_ui.applyLinkButton->isEnabled();
+}
+
+void ControlsDockWidget::enableLinkEditing(bool enable)
+{
+    m_ui.linkStartEdit->setEnabled(enable);
+    m_ui.linkEndEdit->setEnabled(enable);
+    m_ui.linkWeightSpinner->setEnabled(enable);
+    m_ui.applyLinkButton->setEnabled(enable);
+}
+
 bool ControlsDockWidget::highlightStartNode() const
 {
     return m_ui.highlightStartCheck->isChecked();
@@ -128,6 +178,13 @@ bool ControlsDockWidget::highlightPath() const
     return m_ui.highlightPathCheck->isChecked();
 }
 
+void ControlsDockWidget::setHighlightOptions(bool start, bool end, bool path)
+{
+    m_ui.highlightStartCheck->setChecked(start);
+    m_ui.highlightEndCheck->setChecked(end);
+    m_ui.highlightPathCheck->setChecked(path);
+}
+
 int ControlsDockWidget::maxIterations() const
 {
     return m_ui.maxIterationsSpinner->value();
@@ -138,6 +195,50 @@ double ControlsDockWidget::layoutTolerance() const
     return m_ui.layoutToleranceSpinner->value();
 }
 
+RoutingAlgorithm ControlsDockWidget::routingAlgorithm() const
+{
+    // The combo box entries are in RoutingAlgorithm order
+    return static_cast<RoutingAlgorithm>(
+        m_ui.routingAlgorithmCombo->currentIndex());
+}
+
+void ControlsDockWidget::setRoutingAlgorithm(RoutingAlgorithm algorithm)
+{
+    m_ui.routingAlgorithmCombo->setCurrentIndex(algorithm);
+}
+
+int ControlsDockWidget::landmarkCount() const
+{
+    return m_ui.landmarkCountSpinner->value();
+}
+
+int ControlsDockWidget::pathCount() const
+{
+    return m_ui.pathCountSpinner->value();
+}
+
+int ControlsDockWidget::bucketWidth() const
+{
+    // Zero shows as "Auto" and lets the engine choose
+    return m_ui.bucketWidthSpinner->value();
+}
+
+QString ControlsDockWidget::linkStart() const
+{
+    return m_ui.linkStartEdit->text().trimmed();
+}
+
+QString ControlsDockWidget::linkEnd() const
+{
+    return m_ui.linkEndEdit->text().trimmed();
+}
+
+int ControlsDockWidget::linkWeight() const
+{
+    // The minimum shows as "Remove", matching -1 in the specification
+    return m_ui.linkWeightSpinner->value();
+}
+
 // Event handlers
 void ControlsDockWidget::problemSpecChanged()
 {
@@ -178,6 +279,45 @@ void ControlsDockWidget::routeClicked()
     }
 }
 
+void ControlsDockWidget::openSpecClicked()
+{
+    // Large specifications are read straight from disk rather than pasted
+    QString fileName = QFileDialog::getOpenFileName(this,
+        "Open Network Specification", QString(),
+        "Networks (*.txt *.spec *.nrb *.nrs);;All files (*)");
+    if (!fileName.isEmpty()) {
+        emit loadRequested(fileName);
+    }
+}
+
+void ControlsDockWidget::convertSpecClicked()
+{
+    QString specName = QFileDialog::getOpenFileName(this,
+        "Convert Network Specification", QString(),
+        "Specifications (*.txt *.spec);;All files (*)");
+    if (specName.isEmpty()) {
+        return;
+    }
+
+    QFileInfo info(specName);
+    QString   networkName = QFileDialog::getSaveFileName(this,
+        "Save Binary Network",
+        info.dir().filePath(info.completeBaseName() + ".nrb"),
+        "Binary networks (*.nrb)");
+    if (!networkName.isEmpty()) {
+        emit convertRequested(specName, networkName);
+    }
+}
+
+void ControlsDockWidget::saveSessionClicked()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Session",
+        QString(), "Sessions (*.nrs)");
+    if (!fileName.isEmpty()) {
+        emit saveRequested(fileName);
+    }
+}
+
 void ControlsDockWidget::clipboardDataChanged()
 {
     QClipboard* clipboard = QApplication::clipboard();
@@ -12,6 +12,8 @@
 
 #include "ui_controlsdockwidget.h"
 
+#include "routinggraph.h"
+
 class MainWindow;
 
 
@@ -33,24 +35,48 @@ public:
     bool isClearNetworkEnabled() const;
     void enableClearNetwork(bool enable);
 
+    bool isRoutingTableEnabled() const;
+    void enableRoutingTable(bool enable);
+
     bool isGenerateReportEnabled() const;
     void enableGenerateReport(bool enable);
 
+    bool isLinkEditingEnabled() const;
+    void enableLinkEditing(bool enable);
+
     bool highlightStartNode() const;
     bool highlightEndNode() const;
     bool highlightPath() const;
+    void setHighlightOptions(bool start, bool end, bool path);
 
     int  maxIterations() const;
     double layoutTolerance() const;
 
+    RoutingAlgorithm routingAlgorithm() const;
+    void setRoutingAlgorithm(RoutingAlgorithm algorithm);
+    int  landmarkCount() const;
+    int  pathCount() const;
+    int  bucketWidth() const;
+
+    QString linkStart() const;
+    QString linkEnd() const;
+    int  linkWeight() const;
+
 protected slots:
     void problemSpecChanged();
     void pasteAndRouteClicked();
     void routeClicked();
+    void openSpecClicked();
+    void convertSpecClicked();
+    void saveSessionClicked();
     void clipboardDataChanged();
 
 signals:
     void parseRequested(const QString& description);
+    void loadRequested(const QString& fileName);
+    void convertRequested(const QString& specName,
+                          const QString& networkName);
+    void saveRequested(const QString& fileName);
 
 private:
     Ui::ControlsDockWidget  m_ui;
@@ -9,48 +9,33 @@
 #define GRAPH_H
 
 // Boost.Graph stuff
-#include <boost/random.hpp>
 #include <boost/property_map/property_map.hpp>
 #include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/core_numbers.hpp>
-#include <boost/graph/erdos_renyi_generator.hpp>
-#include <boost/graph/kamada_kawai_spring_layout.hpp>
-#include <boost/graph/random.hpp>
-#include <boost/graph/random_layout.hpp>
-#include <boost/graph/topology.hpp>
 
 // Local node and edge types
 #include "nodeitem.h"
 #include "edgeitem.h"
 
 
-// General typedefs
-typedef boost::rand48 RandomNumberGenerator;
-typedef boost::rectangle_topology<RandomNumberGenerator> Topology;
-typedef Topology::point TopologicalPoint;
-
-// Node meta-data
+// Node meta-data; positions are worked out by GraphLayout in the core
 struct NodeProperties
 {
-    TopologicalPoint pos;
     NodeItem*   item;
 
     NodeProperties(NodeItem* item_ = nullptr)
         : item(item_)
     {
-        // Initialise the point
-        pos[0] = 0.0f;
-        pos[1] = 0.0f;
     }
 };
 
-// Edge meta-data
+// Edge meta-data; the weight is a double, like Boost.Graph's distances, so
+// that every integer link weight is held exactly
 struct EdgeProperties
 {
-    float       weight;
+    double      weight;
     EdgeItem*   item;
 
-    EdgeProperties(EdgeItem* item_ = nullptr, float weight_ = 0.0f)
+    EdgeProperties(EdgeItem* item_ = nullptr, double weight_ = 0.0)
         : weight(weight_)
         , item(item_)
     {
@@ -59,19 +44,18 @@ struct EdgeProperties
 
 
 // Graph types
-typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
-    NodeProperties, EdgeProperties, boost::no_property, boost::listS>
-        Graph;
-typedef Graph::vertex_descriptor GraphVertex;
-typedef Graph::vertex_iterator   GraphVertexIterator;
-
 typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
     NodeProperties, EdgeProperties, boost::no_property, boost::listS>
         Digraph;
 typedef Digraph::vertex_descriptor DigraphVertex;
 typedef Digraph::vertex_iterator   DigraphVertexIterator;
 
-typedef boost::erdos_renyi_iterator<RandomNumberGenerator, Graph> RandomIterator;
+
+// Keys for QGraphicsItem::data() that link scene items back to the graph
+enum ItemDataKey {
+    VertexIndexKey  = 0,
+    EdgeIndexKey    = 1,
+};
 
 
 #endif  /* !GRAPH_H */
@@ -5,11 +5,48 @@
  * file at the root of this repository.
  */
 
+#include <cstring>
+
+#include "batchcommand.h"
+#include "benchmarkcommand.h"
 #include "mainwindow.h"
+#include "routingdaemon.h"
 #include <QtWidgets/QApplication>
 
 int main(int argc, char *argv[])
 {
+    // Batch mode never creates an application object, let alone a window
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        QStringList arguments;
+        for (int i = 2; i < argc; ++i) {
+            arguments << QString::fromLocal8Bit(argv[i]);
+        }
+
+        BatchCommand command;
+        return command.run(arguments);
+    }
+
+    // The benchmark only prints a table
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+        QStringList arguments;
+        for (int i = 2; i < argc; ++i) {
+            arguments << QString::fromLocal8Bit(argv[i]);
+        }
+
+        BenchmarkCommand command;
+        return command.run(arguments);
+    }
+
+    // ...and neither does the daemon, which only needs an event loop
+    if (argc > 1 && strcmp(argv[1], "--daemon") == 0) {
+        QCoreApplication app(argc, argv);
+        RoutingDaemon    daemon;
+        if (!daemon.start(app.arguments().mid(2))) {
+            return 2;
+        }
+        return app.exec();
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
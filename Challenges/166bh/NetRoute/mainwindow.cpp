@@ -5,63 +5,101 @@
  * file at the root of this repository.
  */
 
+#include <algorithm>
 #include <climits>
+#include <memory>
 #include <queue>
 
 #include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtOpenGL/QGLWidget>
+#include <QtWidgets/QApplication>
 #include <QtWidgets/QDockWidget>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QStatusBar>
 
 #include "mainwindow.h"
 
 #include "nodeitem.h"
 #include "edgeitem.h"
 
-// Graph helpers and stuff
-typedef boost::detail::constant_value_property_map<double>
-    ConstantValueDoubleMap;
+// How long each of Yen's routes stays highlighted, in milliseconds
+static const int AlternativeInterval = 1500;
 
-template <typename T = double>
-class MaxIterationsLayoutTolerance : public boost::layout_tolerance<T>
+// How long a rewritten specification file has to settle before it is
+// read again, in milliseconds
+static const int ReloadDelay = 250;
+
+// How often a background job's progress is shown, in milliseconds, and how
+// finely
+static const int ProgressInterval = 100;
+static const int ProgressSteps    = 1000;
+
+// Largest network laid out with Kamada-Kawai when loaded; its all-pairs
+// distances are quadratic, so anything bigger gets the multilevel layout
+static const int SpringLayoutLimit = 2000;
+
+// How many nodes and edges are put in the scene between events, so that a
+// big network does not hold the GUI up while it is drawn
+static const int SceneBatchSize = 1000;
+
+// What a load job leaves for the GUI thread.  The mapping, or the copy, is
+// kept until the scene built from it is finished.
+struct MainWindow::LoadedFile
 {
-    int m_currentIteration;
-    int m_maxIterations;
+    enum Kind {
+        Specification,
+        Network,
+        Session,
+    };
 
-public:
-    MaxIterationsLayoutTolerance(int maxIterations, const T& t = T(0.001)) :
-        boost::layout_tolerance<T>(t),
-        m_currentIteration(0),
-        m_maxIterations(maxIterations)
+    explicit LoadedFile(const QString& fileName)
+        : file(fileName)
+        , data(nullptr)
+        , size(0)
+        , kind(Specification)
+        , networkStatus(NetworkFile::Valid)
+        , sessionStatus(SessionFile::Valid)
+        , readTime(0)
     {
     }
 
-    // Actual function we care about
-    template <typename Graph>
-    bool operator()(T delta_p,
-                    typename boost::graph_traits< Graph >::vertex_descriptor p,
-                    const Graph & g,
-                    bool global)
+    ~LoadedFile()
     {
-        if (m_currentIteration < m_maxIterations) {
-            m_currentIteration += 1;
-
-            // Do the normal thing
-            return boost::layout_tolerance<T>::operator()(delta_p, p, g,
-                                                          global);
-        } else {
-            // Skip out early
-            return true;
+        if (data) {
+            file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
         }
     }
-};
 
+    QFile               file;
+    const char*         data;
+    qint64              size;
+    QByteArray          bytes;
+
+    Kind                kind;
+    SpecParser          spec;
+    NetworkFile         network;
+    NetworkFile::Status networkStatus;
+    SessionFile         session;
+    SessionFile::Status sessionStatus;
+
+    QElapsedTimer       timer;
+    qint64              readTime;
+};
 
 // MainWindow implementation
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , m_routeStart(nullptr)
+    , m_routeEnd(nullptr)
+    , m_alternativeShown(0)
     , m_highlightPath(true)
+    , m_jobPending(false)
+    , m_sceneItemCount(0)
 {
     // Set up the general UI stuff
     m_ui.setupUi(this);
@@ -108,12 +146,71 @@ MainWindow::MainWindow(QWidget *parent)
 
     addDockWidget(Qt::RightDockWidgetArea, m_controlsDock);
 
+    // Cycles through the routes found in K shortest paths mode
+    m_alternativeTimer = new QTimer(this);
+    m_alternativeTimer->setInterval(AlternativeInterval);
+    connect(m_alternativeTimer, &QTimer::timeout, this,
+        &MainWindow::showNextAlternative);
+
+    // Applies a watched specification once it stops changing
+    m_specWatcher = new QFileSystemWatcher(this);
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(ReloadDelay);
+    connect(m_specWatcher, &QFileSystemWatcher::fileChanged, this,
+        &MainWindow::specFileChanged);
+    connect(m_reloadTimer, &QTimer::timeout, this,
+        &MainWindow::reloadSpecFile);
+
+    // Background jobs show their progress in the status bar, where they can
+    // also be stopped
+    m_jobWatcher = new JobWatcher(this);
+    connect(m_jobWatcher, &JobWatcher::finished, this,
+        &MainWindow::jobFinished);
+    m_network.setProgress(&m_jobProgress);
+
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(ProgressInterval);
+    connect(m_progressTimer, &QTimer::timeout, this,
+        &MainWindow::showJobProgress);
+
+    m_progressBar  = new QProgressBar;
+    m_progressBar->setMaximumWidth(200);
+    m_progressBar->hide();
+    m_cancelButton = new QToolButton;
+    m_cancelButton->setText("Cancel");
+    m_cancelButton->hide();
+    connect(m_cancelButton, &QToolButton::clicked, [this] () {
+        // A running job stops where it can and still reports how far it
+        // got; one yet to start, or a half-drawn scene, is simply dropped
+        if (m_jobWatcher->isRunning() && !m_jobPending) {
+            m_jobProgress.cancel();
+            statusBar()->showMessage(QString("%1: stopping...")
+                .arg(m_jobName));
+        } else {
+            postWarningMessage(QString("%1 cancelled.").arg(m_jobName));
+            stopJob();
+        }
+    });
+    statusBar()->addPermanentWidget(m_progressBar);
+    statusBar()->addPermanentWidget(m_cancelButton);
+
+    m_sceneTimer = new QTimer(this);
+    m_sceneTimer->setInterval(0);
+    connect(m_sceneTimer, &QTimer::timeout, this,
+        &MainWindow::createSceneItems);
+
     // Initialisation finished
     postInfoMessage("Ready; paste network description into the text edit.");
 }
 
 MainWindow::~MainWindow()
 {
+    // The job may be using anything in here, so this is the one place that
+    // waits for it
+    cancelJob();
+    m_idleActions.clear();
+    m_jobWatcher->waitForFinished();
 }
 
 // Properties
@@ -208,6 +305,32 @@ void MainWindow::postErrorMessage(const QString& msg)
     postMessage(colour, leader, msg);
 }
 
+void MainWindow::postStage(const NetworkModel::StageResult& stage)
+{
+    // The model words its transcript as the explorer always has
+    for (size_t i = 0; i < stage.messages.size(); ++i) {
+        QString text = QString::fromStdString(stage.messages[i].text);
+
+        switch (stage.messages[i].type) {
+        case NetworkModel::SuccessMessage:
+            postSuccessMessage(text);
+            break;
+
+        case NetworkModel::WarningMessage:
+            postWarningMessage(text);
+            break;
+
+        case NetworkModel::ErrorMessage:
+            postErrorMessage(text);
+            break;
+
+        default:
+            postInfoMessage(text);
+            break;
+        }
+    }
+}
+
 void MainWindow::postMessage(const QString& htmlColour, const QString& leader,
     const QString& msg)
 {
@@ -220,405 +343,1448 @@ void MainWindow::postMessage(const QString& htmlColour, const QString& leader,
 // Graph layout stuff
 void MainWindow::applyRandomLayout()
 {
-    RandomNumberGenerator rng(QDateTime::currentMSecsSinceEpoch());
+    cancelJob();
 
     // Define the topology to work in
     QRectF rc(m_graphView->visibleRegion().boundingRect());
     rc.adjust(-10.0f, -10.0f, -10.0f, -10.0f);
     rc.moveTo(-rc.width() / 2.0f, -rc.height() / 2.0f);
-    Topology top(rng, rc.left(), rc.top(), rc.right(), rc.bottom());
 
     // Apply the layout
-    boost::random_graph_layout(m_graph,
-        get(&NodeProperties::pos, m_graph), top);
+    unsigned seed = static_cast<unsigned>(QDateTime::currentMSecsSinceEpoch());
+    whenIdle([this, rc, seed] () {
+        m_network.randomLayout(rc.left(), rc.top(), rc.right(), rc.bottom(),
+            seed);
+        showLayout();
+    });
+}
 
-    // Forward the calculated values into the graphics objects
-    std::pair<DigraphVertexIterator, DigraphVertexIterator> iterators =
-        boost::vertices(m_graph);
-    DigraphVertexIterator it = iterators.first;
-    for (; it != iterators.second; ++it) {
-        TopologicalPoint pt   = m_graph[*it].pos;
-        NodeItem*        node = m_graph[*it].item;
+void MainWindow::applySpringLayout()
+{
+    cancelJob();
+    layoutNetwork(SpringLayout, Continuation());
+}
+
+void MainWindow::applyForceLayout()
+{
+    cancelJob();
+    layoutNetwork(ForceLayout, Continuation());
+}
+
+void MainWindow::applyMultilevelLayout()
+{
+    cancelJob();
+    layoutNetwork(MultilevelLayout, Continuation());
+}
 
-        node->setPos(pt[0], pt[1]);
+void MainWindow::layoutNetwork(LayoutStyle style,
+    const Continuation& finished)
+{
+    // Define the topology to work in
+    QRectF rc(m_graphView->visibleRegion().boundingRect());
+    float adjH = rc.width()  * 0.1f;
+    float adjV = rc.height() * 0.1f;
+    rc.adjust(adjH, adjV, -adjH, -adjV);
+    rc.moveTo(-rc.width() / 2.0f, -rc.height() / 2.0f);
+
+    int      maxIterations = m_controlsDock->maxIterations();
+    double   tolerance     = m_controlsDock->layoutTolerance();
+    unsigned seed = static_cast<unsigned>(QDateTime::currentMSecsSinceEpoch());
+
+    // Kamada-Kawai, Fruchterman-Reingold or multilevel, all sharing the
+    // iteration and tolerance settings; a cancelled run still shows where
+    // it got to, and whatever comes next carries on from there
+    runJob("Laying out", [this, style, rc, maxIterations, tolerance, seed] () {
+        if (style == MultilevelLayout) {
+            m_network.multilevelLayout(rc.left(), rc.top(), rc.right(),
+                rc.bottom(), maxIterations, tolerance, seed, &m_threadPool);
+        } else if (style == ForceLayout) {
+            m_network.forceLayout(rc.left(), rc.top(), rc.right(),
+                rc.bottom(), maxIterations, tolerance, seed, &m_threadPool);
+        } else {
+            m_network.springLayout(rc.left(), rc.top(), rc.right(),
+                rc.bottom(), maxIterations, tolerance, seed);
+        }
+    }, [this, finished] () {
+        postStage(m_network.layoutResult());
+        showLayout();
+        if (finished) {
+            finished();
+        }
+    });
+}
+
+void MainWindow::showLayout()
+{
+    // Forward the calculated values into the graphics objects, all at once
+    const GraphLayout& layout = m_network.layout();
+    m_graphView->setUpdatesEnabled(false);
+    for (int v = 0; v < layout.vertexCount(); ++v) {
+        NodeItem* node = m_graph[boost::vertex(v, m_graph)].item;
+        node->setPos(layout.x(v), layout.y(v));
     }
+    m_graphView->setUpdatesEnabled(true);
 }
 
-void MainWindow::applySpringLayout()
+// Network specification stuff
+void MainWindow::parseAndRouteNetwork(const QString& description)
 {
-    ConstantValueDoubleMap weights(1.0f);
-    RandomNumberGenerator rng(QDateTime::currentMSecsSinceEpoch());
+    // A new network supersedes whatever is still being worked on
+    cancelJob();
+
+    // Pasted text replaces whatever file was being followed
+    watchSpecFile(QString());
+
+    QByteArray                  bytes = description.toUtf8();
+    std::shared_ptr<SpecParser> spec(new SpecParser);
+    runJob("Parsing", [this, bytes, spec] () {
+        spec->parse(bytes.constData(), bytes.size(), &m_threadPool);
+    }, [this, spec] () {
+        // The parser cannot stop part way, so the rest is skipped instead
+        if (m_jobProgress.isCancelled()) {
+            postWarningMessage("Parsing cancelled; the network is as it was.");
+            return;
+        }
+        if (!patchNetwork(*spec)) {
+            buildNetwork(*spec, [this] (int buildResult) {
+                routeBuiltNetwork(buildResult);
+            });
+        }
+    });
+}
 
-    // Create an undirected copy of the graph
-    QMap<GraphVertex, DigraphVertex> mapDtoU;
-    QMap<DigraphVertex, GraphVertex> mapUtoD;
-    Graph g;
+void MainWindow::loadAndRouteNetwork(const QString& fileName)
+{
+    cancelJob();
 
-    {
-        // Copy the nodes
-        std::pair<DigraphVertexIterator, DigraphVertexIterator> digraphVertices
-            = boost::vertices(m_graph);
-        DigraphVertexIterator vit = digraphVertices.first;
-        for (; vit != digraphVertices.second; vit++) {
-            // Add the vertex
-            GraphVertex v = boost::add_vertex(m_graph[*vit], g);
+    std::shared_ptr<LoadedFile> loaded(new LoadedFile(fileName));
+    if (!mapFile(loaded->file, loaded->data, loaded->size)) {
+        return;
+    }
 
-            // Create the mapping
-            mapDtoU[*vit] = v;
-            mapUtoD[v]    = *vit;
+    // Binary networks are used in place; text is parsed straight out of the
+    // page cache.  Either way the mapping must outlive the build.
+    runJob("Loading", [this, loaded] () {
+        const char* data = loaded->data;
+        size_t      size = static_cast<size_t>(loaded->size);
+
+        loaded->timer.start();
+        if (SessionFile::isSessionFile(data, size)) {
+            loaded->kind          = LoadedFile::Session;
+            loaded->sessionStatus = loaded->session.read(data, size);
+        } else if (NetworkFile::isNetworkFile(data, size)) {
+            loaded->kind          = LoadedFile::Network;
+            loaded->networkStatus = loaded->network.read(data, size);
+        } else {
+            loaded->kind = LoadedFile::Specification;
+            loaded->spec.parse(data, size, &m_threadPool);
+        }
+        loaded->readTime = loaded->timer.elapsed();
+    }, [this, loaded, fileName] () {
+        // Reading cannot stop part way, so the rest is skipped instead
+        if (m_jobProgress.isCancelled()) {
+            postWarningMessage("Loading cancelled; the network is as it was.");
+            return;
         }
 
-        // Copy the edges
-        std::pair<Digraph::edge_iterator, Digraph::edge_iterator> digraphEdges
-            = boost::edges(m_graph);
-        Digraph::edge_iterator eit = digraphEdges.first;
-        for (; eit != digraphEdges.second; eit++) {
-            // Get the nodes in terms of the undirected graph
-            DigraphVertex src = boost::source(*eit, m_graph);
-            DigraphVertex tgt = boost::target(*eit, m_graph);
+        if (loaded->kind == LoadedFile::Session) {
+            SessionFile::Status status = loaded->sessionStatus;
+            if (status != SessionFile::Valid) {
+                postErrorMessage(QString("'%1' is not a usable session: %2.")
+                    .arg(fileName)
+                    .arg(status == SessionFile::BadVersion ?
+                            "unknown version" :
+                         status == SessionFile::Truncated ?
+                            "file is truncated" : "file is corrupt"));
+                return;
+            }
+
+            // A snapshot is already laid out and routed, so it skips both
+            buildNetwork(loaded->session.network(),
+                [this, loaded] (int buildResult) {
+                    if (buildResult >= 0 &&
+                            (buildResult & WarningAbort) == 0) {
+                        restoreSession(loaded->session);
+                        postSuccessMessage(QString("Session restored in %1 "
+                            "ms.")
+                                .arg(loaded->timer.elapsed()));
+                    }
+                    if (buildResult < 0) {
+                        clearNetwork();
+                    }
+                });
+        } else if (loaded->kind == LoadedFile::Network) {
+            NetworkFile::Status status = loaded->networkStatus;
+            if (status != NetworkFile::Valid) {
+                postErrorMessage(QString("'%1' is not a usable network file: "
+                    "%2.")
+                        .arg(fileName)
+                        .arg(status == NetworkFile::BadVersion ?
+                                "unknown version" :
+                             status == NetworkFile::Truncated ?
+                                "file is truncated" : "file is corrupt"));
+                return;
+            }
 
-            // Add an edge into the undirected graph
-            boost::add_edge(mapDtoU[src], mapDtoU[tgt], m_graph[*eit], g);
+            postInfoMessage(QString("Checked %1 nodes and %2 links in %3 ms.")
+                .arg(loaded->network.vertexCount())
+                .arg(loaded->network.edgeCount())
+                .arg(loaded->readTime));
+            buildNetwork(loaded->network, [this, loaded] (int buildResult) {
+                routeBuiltNetwork(buildResult);
+            });
+        } else {
+            postInfoMessage(QString("Parsed %1 lines and %2 links in %3 ms.")
+                .arg(loaded->spec.lineCount())
+                .arg(loaded->spec.edges().size())
+                .arg(loaded->readTime));
+
+            // The same nodes again are only patched, and text is followed
+            // for further changes
+            if (patchNetwork(loaded->spec)) {
+                return;
+            }
+            buildNetwork(loaded->spec,
+                [this, loaded, fileName] (int buildResult) {
+                    if (buildResult >= 0 &&
+                            (buildResult & WarningAbort) == 0) {
+                        watchSpecFile(fileName);
+                    }
+                    routeBuiltNetwork(buildResult);
+                });
         }
+    });
+}
+
+void MainWindow::convertNetworkFile(const QString& specName,
+                                    const QString& networkName)
+{
+    cancelJob();
+
+    std::shared_ptr<LoadedFile> loaded(new LoadedFile(specName));
+    if (!mapFile(loaded->file, loaded->data, loaded->size)) {
+        return;
     }
 
-    // Define the topology to work in
-    QRectF rc(m_graphView->visibleRegion().boundingRect());
-    float adjH = rc.width()  * 0.1f;
-    float adjV = rc.height() * 0.1f;
-    rc.adjust(adjH, adjV, -adjH, -adjV);
-    rc.moveTo(-rc.width() / 2.0f, -rc.height() / 2.0f);
+    // Parsing, resolving and writing all happen off the GUI thread; the
+    // start/end lines that had to be skipped are reported afterwards
+    typedef NetworkModel::StageResult StageResult;
+    std::shared_ptr<StageResult> parsed(new StageResult);
+    std::shared_ptr<bool>        written(new bool(false));
+    runJob("Converting", [this, loaded, networkName, parsed, written] () {
+        const SpecParser& spec = loaded->spec;
+
+        loaded->timer.start();
+        loaded->spec.parse(loaded->data, static_cast<size_t>(loaded->size),
+            &m_threadPool);
+        if (spec.status() != SpecParser::Parsed ||
+                m_jobProgress.isCancelled()) {
+            return;
+        }
 
-    Topology top(rng, rc.left(), rc.top(), rc.right(), rc.bottom());
+        // Start/end lines are read as a load would, and stored as node
+        // indices
+        std::vector<std::pair<int, int> > queries;
+        for (size_t i = 0; i < spec.queryLines().size(); ++i) {
+            RouteQuery query;
+            if (NetworkModel::parseRouteQuery(spec.queryLines()[i],
+                    spec.names(), query, *parsed) == Success) {
+                queries.push_back(std::make_pair(query.source, query.target));
+            }
+        }
 
-    MaxIterationsLayoutTolerance<double> done(
-                boost::num_vertices(m_graph) * m_controlsDock->maxIterations(),
-                m_controlsDock->layoutTolerance());
+        *written = NetworkFile::write(networkName.toStdString(), spec.names(),
+            spec.edges(), queries);
+        loaded->readTime = loaded->timer.elapsed();
+    }, [this, loaded, specName, networkName, parsed, written] () {
+        const SpecParser& spec = loaded->spec;
+
+        if (spec.status() != SpecParser::Parsed) {
+            postErrorMessage(QString("'%1' is not a valid specification; load "
+                "it to see why.")
+                    .arg(specName));
+            return;
+        }
+        if (m_jobProgress.isCancelled() && !*written) {
+            postWarningMessage(QString("Conversion cancelled; '%1' was not "
+                "written.")
+                    .arg(networkName));
+            return;
+        }
 
-    // Seed with a random layout
-    boost::random_graph_layout(g, get(&NodeProperties::pos, g), top);
+        for (size_t i = 0; i < spec.badCells().size(); ++i) {
+            postBadCellMessage(spec.badCells()[i]);
+        }
+        postStage(*parsed);
 
-    // Now apply the force-directed layout
-    boost::kamada_kawai_spring_layout(g,
-        get(&NodeProperties::pos, g), weights, top,
-        boost::side_length(rc.width()), done);
+        if (!*written) {
+            postErrorMessage(QString("Failed to write '%1'.")
+                .arg(networkName));
+            return;
+        }
 
-    // Forward the calculated values into the graphics objects
-    std::pair<GraphVertexIterator, GraphVertexIterator> iterators =
-        boost::vertices(g);
-    GraphVertexIterator it = iterators.first;
-    for (; it != iterators.second; ++it) {
-        TopologicalPoint pt   = g[*it].pos;
-        NodeItem*        node = g[*it].item;
+        postSuccessMessage(QString("Wrote %1 nodes and %2 links to %3 (%4 "
+            "bytes, from %5) in %6 ms.")
+                .arg(spec.nodeCount())
+                .arg(spec.edges().size())
+                .arg(networkName)
+                .arg(QFileInfo(networkName).size())
+                .arg(loaded->size)
+                .arg(loaded->readTime));
+    });
+}
 
-        // Set the scene item
-        node->setPos(pt[0], pt[1]);
+void MainWindow::saveSession(const QString& fileName)
+{
+    cancelJob();
+    whenIdle([this, fileName] () { writeSession(fileName); });
+}
 
-        // Update the digraph
-        m_graph[mapUtoD[*it]].pos = pt;
+void MainWindow::writeSession(const QString& fileName)
+{
+    if (boost::num_vertices(m_graph) == 0) {
+        postErrorMessage("There is no network to save.");
+        return;
+    }
+
+    QElapsedTimer       timer;
+    const RoutingGraph& graph = m_network.graph();
+    timer.start();
+
+    // Removed edges are dropped and added ones join their rows, so the
+    // survivors are renumbered in the order the snapshot will load them
+    std::vector<int> order;
+    for (int e = 0; e < graph.edgeCount(); ++e) {
+        if (graph.hasEdge(e)) {
+            order.push_back(e);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&graph] (int a, int b) {
+        return graph.edge(a).source < graph.edge(b).source;
+    });
+
+    std::vector<RoutingEdge> edges;
+    std::vector<int>         renumbered(graph.edgeCount(), -1);
+    for (size_t i = 0; i < order.size(); ++i) {
+        edges.push_back(graph.edge(order[i]));
+        renumbered[order[i]] = static_cast<int>(i);
+    }
+
+    const std::vector<RouteQuery>&    routeQueries = m_network.queries();
+    std::vector<std::pair<int, int> > queries;
+    for (size_t i = 0; i < routeQueries.size(); ++i) {
+        queries.push_back(
+            std::make_pair(routeQueries[i].source, routeQueries[i].target));
+    }
+
+    // Nodes may have been dragged since the layout ran, so the scene has
+    // the positions worth keeping
+    std::vector<double> positions;
+    for (int v = 0; v < graph.vertexCount(); ++v) {
+        QPointF pt = m_graph[boost::vertex(v, m_graph)].item->pos();
+        positions.push_back(pt.x());
+        positions.push_back(pt.y());
+    }
+
+    std::vector<int> route;
+    QListIterator<EdgeItem*> i(m_route);
+    while (i.hasNext()) {
+        route.push_back(renumbered[i.next()->data(EdgeIndexKey).toInt()]);
+    }
+
+    int source = m_routeStart ? m_routeStart->data(VertexIndexKey).toInt() : -1;
+    int target = m_routeEnd   ? m_routeEnd->data(VertexIndexKey).toInt()   : -1;
+
+    unsigned style = 0;
+    if (m_controlsDock->highlightStartNode()) {
+        style |= SessionFile::HighlightStart;
+    }
+    if (m_controlsDock->highlightEndNode()) {
+        style |= SessionFile::HighlightEnd;
+    }
+    if (m_controlsDock->highlightPath()) {
+        style |= SessionFile::HighlightPath;
+    }
+
+    if (!SessionFile::write(fileName.toStdString(), m_network.names(), edges,
+            queries, positions, source, target, route, style,
+            m_controlsDock->routingAlgorithm())) {
+        postErrorMessage(QString("Failed to write '%1'.").arg(fileName));
+        return;
     }
+
+    postSuccessMessage(QString("Saved session of %1 nodes and %2 links to %3 "
+        "(%4 bytes) in %5 ms.")
+            .arg(graph.vertexCount())
+            .arg(edges.size())
+            .arg(fileName)
+            .arg(QFileInfo(fileName).size())
+            .arg(timer.elapsed()));
 }
 
-// Network specification stuff
-void MainWindow::parseAndRouteNetwork(const QString& description)
+// Background jobs
+void MainWindow::runJob(const QString& name, const Continuation& work,
+    const Continuation& finished)
+{
+    cancelJob();
+
+    m_jobWork     = work;
+    m_jobPending  = true;
+    m_jobFinished = finished;
+    announceJob(name);
+
+    // A superseded job still stopping starts this one when it is done
+    if (!m_jobWatcher->isRunning()) {
+        startJob();
+    }
+}
+
+void MainWindow::startJob()
+{
+    Continuation work;
+    work.swap(m_jobWork);
+    m_jobPending = false;
+    m_jobProgress.reset();
+
+    m_jobWatcher->setFuture(QtConcurrent::run(work));
+}
+
+bool MainWindow::stopJob()
+{
+    // Whatever was to follow superseded work is dropped along with it.  A
+    // running job stops at the next point it can, in the background; one
+    // still waiting never starts, and a half-drawn scene is taken down.
+    bool stopped = false;
+    if (m_jobPending) {
+        m_jobWork    = Continuation();
+        m_jobPending = false;
+        stopped      = true;
+    } else if (m_jobWatcher->isRunning() && m_jobFinished) {
+        m_jobProgress.cancel();
+        stopped = true;
+    }
+    m_jobFinished = Continuation();
+
+    if (m_sceneTimer->isActive()) {
+        m_sceneTimer->stop();
+        m_sceneFinished = Continuation();
+        m_graphView->setUpdatesEnabled(true);
+        removeNetwork();
+        stopped = true;
+    }
+
+    hideJobProgress();
+    return stopped;
+}
+
+void MainWindow::cancelJob()
+{
+    QString name = m_jobName;
+    if (stopJob()) {
+        postWarningMessage(QString("%1 superseded.").arg(name));
+    }
+}
+
+void MainWindow::whenIdle(const Continuation& action)
+{
+    // The model is only changed from here once the job using it has stopped
+    if (m_jobWatcher->isRunning()) {
+        m_idleActions.append(action);
+    } else {
+        action();
+    }
+}
+
+void MainWindow::jobFinished()
+{
+    // Changes held back for a superseded job go first, then the job that
+    // was waiting for it to stop
+    while (!m_idleActions.isEmpty()) {
+        m_idleActions.takeFirst()();
+    }
+    if (m_jobPending) {
+        startJob();
+        return;
+    }
+
+    Continuation finished;
+    finished.swap(m_jobFinished);
+
+    hideJobProgress();
+    if (finished) {
+        finished();
+    }
+}
+
+void MainWindow::announceJob(const QString& name)
+{
+    m_jobName = name;
+
+    statusBar()->showMessage(QString("%1...").arg(name));
+    m_progressBar->setRange(0, 0);
+    m_progressBar->show();
+    m_cancelButton->show();
+    m_progressTimer->start();
+}
+
+void MainWindow::showJobProgress()
+{
+    // Stages that cannot tell how far along they are just show activity, as
+    // does a job waiting for another to stop
+    double fraction = m_jobPending ? -1.0 : m_jobProgress.fraction();
+    if (fraction < 0.0) {
+        m_progressBar->setRange(0, 0);
+    } else {
+        m_progressBar->setRange(0, ProgressSteps);
+        m_progressBar->setValue(static_cast<int>(fraction * ProgressSteps));
+    }
+}
+
+void MainWindow::hideJobProgress()
+{
+    m_progressTimer->stop();
+    m_progressBar->hide();
+    m_cancelButton->hide();
+    statusBar()->clearMessage();
+}
+
+bool MainWindow::mapFile(QFile& file, const char*& data, qint64& size)
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        postErrorMessage(QString("Cannot open '%1': %2")
+            .arg(file.fileName())
+            .arg(file.errorString()));
+        return false;
+    }
+
+    // An empty file cannot be mapped, but it is not an error either
+    size = file.size();
+    data = nullptr;
+    postInfoMessage(QString("Mapping %1 (%2 bytes)...")
+        .arg(file.fileName())
+        .arg(size));
+    if (size == 0) {
+        return true;
+    }
+
+    data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data) {
+        postErrorMessage(QString("Cannot map '%1': %2")
+            .arg(file.fileName())
+            .arg(file.errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+void MainWindow::watchSpecFile(const QString& fileName)
+{
+    m_reloadTimer->stop();
+    if (!m_specWatcher->files().isEmpty()) {
+        m_specWatcher->removePaths(m_specWatcher->files());
+    }
+
+    m_specFileName = fileName;
+    if (!fileName.isEmpty()) {
+        m_specWatcher->addPath(fileName);
+    }
+}
+
+void MainWindow::specFileChanged(const QString& fileName)
+{
+    // Editors that save by replacing the file take it off the watch list
+    if (!m_specWatcher->files().contains(fileName) &&
+            QFileInfo(fileName).exists()) {
+        m_specWatcher->addPath(fileName);
+    }
+
+    // Saves often arrive as several writes; wait for the last of them
+    m_reloadTimer->start();
+}
+
+void MainWindow::reloadSpecFile()
+{
+    cancelJob();
+
+    postInfoMessage(QString("'%1' changed on disk; applying it...")
+        .arg(m_specFileName));
+
+    // Copied rather than mapped: the file may be truncated again while it
+    // is being parsed, and a mapping would fault
+    std::shared_ptr<LoadedFile> loaded(new LoadedFile(m_specFileName));
+    runJob("Reloading", [this, loaded] () {
+        if (loaded->file.open(QIODevice::ReadOnly)) {
+            loaded->bytes = loaded->file.readAll();
+            loaded->spec.parse(loaded->bytes.constData(),
+                loaded->bytes.size(), &m_threadPool);
+        }
+    }, [this, loaded] () {
+        QString fileName = loaded->file.fileName();
+        if (m_jobProgress.isCancelled()) {
+            postWarningMessage("Reloading cancelled; the network is as it "
+                "was.");
+            return;
+        }
+        if (!loaded->file.isOpen()) {
+            postWarningMessage(QString("Cannot read '%1'; keeping the network "
+                "as it is.")
+                    .arg(fileName));
+            return;
+        }
+
+        // A half-written file must not take the network down with it
+        if (loaded->spec.status() != SpecParser::Parsed) {
+            postWarningMessage(QString("'%1' is not a complete specification "
+                "yet; keeping the network as it is.")
+                    .arg(fileName));
+            return;
+        }
+
+        if (!patchNetwork(loaded->spec)) {
+            buildNetwork(loaded->spec,
+                [this, loaded, fileName] (int buildResult) {
+                    routeBuiltNetwork(buildResult);
+                    if (boost::num_vertices(m_graph) > 0) {
+                        watchSpecFile(fileName);
+                    }
+                });
+        }
+    });
+}
+
+void MainWindow::routeBuiltNetwork(int buildResult)
 {
-    // Attempt to build the graph
-    int buildResult = buildNetwork(description);
     if (buildResult < 0) {
         // Error occurred; just clear everything and abort
         clearNetwork();
         return;
     }
 
-    // Load complete, lay it out
+    // Load complete, lay it out; routing follows once that is done
     if ((buildResult & WarningAbort) == 0) {
         postInfoMessage("Laying out graph...");
-        applySpringLayout();
-        postSuccessMessage("Graph loaded successfully!");
+        LayoutStyle style =
+            m_network.graph().vertexCount() > SpringLayoutLimit ?
+                MultilevelLayout : SpringLayout;
+        layoutNetwork(style, [this, buildResult] () {
+            postSuccessMessage("Graph loaded successfully!");
+
+            // Enable the UI
+            m_controlsDock->enableClearNetwork(true);
+            m_controlsDock->enableRoutingTable(true);
+            m_controlsDock->enableLinkEditing(true);
+            m_controlsDock->enableGraphLayoutOptions(true);
+
+            routeFirstQuery(buildResult);
+        });
+    }
 
-        // Enable the UI
-        m_controlsDock->enableClearNetwork(true);
-        m_controlsDock->enableGraphLayoutOptions(true);
+}
 
-        // Extract the start and end points
-        if (buildResult == Success) {
-            postInfoMessage("Beginning routing step...");
-            routeNetwork();
+void MainWindow::routeFirstQuery(int buildResult)
+{
+    // A patched network may still be showing an older route
+    stopAlternatives();
+    if (m_routeStart) {
+        clearNodeStyle(m_routeStart);
+        m_routeStart->setEmphasised(false);
+    }
+    if (m_routeEnd) {
+        clearNodeStyle(m_routeEnd);
+        m_routeEnd->setEmphasised(false);
+    }
+    QListIterator<EdgeItem*> i(m_route);
+    while (i.hasNext()) {
+        i.next()->setEmphasised(false);
+    }
 
-            // Enable the graph display controls and the report generator
-            m_controlsDock->enableGraphDisplayOptions(true);
-            m_controlsDock->enableGenerateReport(true);
-        } else {
-            // Make sure the route does not exist
-            m_routeStart = m_routeEnd = nullptr;
-            m_route.clear();
+    // Extract the start and end points; the first pair is the one drawn
+    if (buildResult == Success) {
+        const RouteQuery& first = m_network.queries()[0];
+        m_routeStart = m_graph[boost::vertex(first.source, m_graph)].item;
+        m_routeEnd   = m_graph[boost::vertex(first.target, m_graph)].item;
 
-            // Disable the UI stuff that depends on the route being generated
-            m_controlsDock->enableGraphDisplayOptions(false);
-            m_controlsDock->enableGenerateReport(false);
+        postInfoMessage("Beginning routing step...");
+        routeNetwork();
 
-            // Inform the user
-            postErrorMessage("Routing skipped step due to warnings.");
-        }
-    }
+        // Enable the graph display controls and the report generator
+        m_controlsDock->enableGraphDisplayOptions(true);
+        m_controlsDock->enableGenerateReport(true);
+    } else {
+        // Make sure the route does not exist
+        m_routeStart = m_routeEnd = nullptr;
+        m_route.clear();
 
+        // Disable the UI stuff that depends on the route being generated
+        m_controlsDock->enableGraphDisplayOptions(false);
+        m_controlsDock->enableGenerateReport(false);
+
+        // Inform the user
+        postErrorMessage("Routing skipped step due to warnings.");
+    }
 }
 
-int MainWindow::buildNetwork(const QString& description)
+void MainWindow::buildNetwork(SpecParser& spec, const BuildFinished& built)
 {
-    int result = Success;
+    // Nothing is given up for a specification that cannot be loaded
+    NetworkModel::StageResult checked;
+    int                       result = NetworkModel::check(spec, checked);
+    if (result < 0) {
+        postStage(checked);
+        built(result);
+        return;
+    }
 
-    // Split into lines
-    QStringList lines = description.split(QRegExp("[\\n|\\r]"),
-        QString::SkipEmptyParts);
-    if (lines.isEmpty()) {
-        postErrorMessage("Problem specification is empty after whitespace "
-            "removed!");
-        return ErrorEmpty;
+    if (!discardNetwork()) {
+        built(WarningAbort);
+        return;
     }
 
-    // Validate the length of the specification
-    int nodeCount = lines[0].toInt();
-    postInfoMessage(QString("Expecting %1x%1 adjacency matrix...")
-        .arg(nodeCount));
+    // Build the compact routing representation, then the scene from that.
+    // Graph was built successfully, even if some parsing errors arose.
+    result = m_network.load(spec);
+    postStage(m_network.loadResult());
+    createNetwork([built, result] () { built(result); });
+}
+
+void MainWindow::buildNetwork(const NetworkFile& network,
+    const BuildFinished& built)
+{
+    NetworkModel::StageResult checked;
+    int                       result = NetworkModel::check(network, checked);
+    if (result < 0) {
+        postStage(checked);
+        built(result);
+        return;
+    }
 
-    if (lines.length() != (nodeCount + 2)) {
-        postErrorMessage(QString("Expecting %1 lines in specification; read %2")
-            .arg(nodeCount + 2)
-            .arg(lines.length()));
-        return ErrorSpecTooSmall;
+    if (!discardNetwork()) {
+        built(WarningAbort);
+        return;
     }
 
-    // Clear the existing graph and scene
-    if (boost::num_vertices(m_graph) != 0) {
-        postWarningMessage("Existing network already loaded; must be cleared "
-            "in order to continue.");
+    // The arrays are already in CSR order, so there are no edges to gather
+    result = m_network.load(network);
+    postStage(m_network.loadResult());
+    createNetwork([built, result] () { built(result); });
+}
 
-        int response = QMessageBox::question(this, "NetRoute", "There is "
-            "already a graph in the explorer; the current data will have to "
-            "be discared.  Continue?");
-        if (response == QMessageBox::No) {
-            postErrorMessage("Aborted by user.");
-            return WarningAbort;
+bool MainWindow::patchNetwork(const SpecParser& spec)
+{
+    // Only a specification of the same nodes, in the same order, can be
+    // applied to the network already loaded
+    const RoutingGraph& graph = m_network.graph();
+    int                 n     = graph.vertexCount();
+    if (n == 0 || spec.status() != SpecParser::Parsed ||
+            spec.nodeCount() != n) {
+        return false;
+    }
+    for (int v = 0; v < n; ++v) {
+        if (spec.names().name(v) != m_network.names().name(v)) {
+            return false;
         }
-
-        postInfoMessage("Discarding network.");
-        clearNetwork();
     }
 
-    // Create the nodes
-    postInfoMessage("Creating nodes...");
-    for (int i = 0; i < nodeCount; ++i) {
-        QString name = QString("%1").arg(QChar('A' + i));
-
-        NodeItem* node = new NodeItem;
-        node->setText(name);
-        
-        m_graphNodes[name] = node;
-        
-        boost::add_vertex(NodeProperties(node), m_graph);
-
-        m_graphScene->addItem(node);
-    }
-
-    // Create the edges
-    postInfoMessage("Creating edges from adjacency matrix...");
-    for (int i = 0; i < nodeCount; ++i) {
-        QString     line    = lines[i + 1].trimmed();
-        QStringList weights = line.split(',', QString::SkipEmptyParts);
-
-        // Sanity check
-        if (weights.length() != nodeCount) {
-            postErrorMessage(
-                QString("Matrix row %1 has %2 columns; expecting %3.")
-                    .arg(i)
-                    .arg(weights.length())
-                    .arg(nodeCount));
-            return ErrorRowTooShort;
-        }
-
-        // Actually create the edges
-        postInfoMessage(QString("Creating edges for node %1")
-            .arg(QChar('A' + i)));
-        DigraphVertex vStart = boost::vertex(i, m_graph);
-        for (int j = 0; j < nodeCount; ++j) {
-            bool ok;
-            int weight = weights[j].trimmed().toInt(&ok);
-
-            if (ok && weight >= 0) {
-                DigraphVertex vEnd = boost::vertex(j, m_graph);
-
-                // Create the new edge item
-                EdgeItem* edge = new EdgeItem;
-                edge->setStartNode(m_graph[vStart].item);
-                edge->setEndNode(m_graph[vEnd].item);
-                edge->setWeight(weight);
-                m_graphScene->addItem(edge);
-
-                // Add it to the graph
-                boost::add_edge(vStart, vEnd, EdgeProperties(edge), m_graph);
-            } else if (!ok) {
-                postWarningMessage(QString("Weight (%1,%2) is malformed: %3.")
-                    .arg(i)
-                    .arg(j)
-                    .arg(weights[j]));
-                result |= WarningBadCell;
+    // Diff each row against the arcs out of its node.  Everything is found
+    // before anything is edited, as editing moves the arcs about.
+    const std::vector<RoutingEdge>&   edges = spec.edges();
+    std::vector<int>                  linkTo(n, -1);
+    std::vector<RoutingEdge>          added;
+    std::vector<std::pair<int, int> > reweighted;
+    std::vector<int>                  removed;
+    size_t                            next = 0;
+
+    for (int v = 0; v < n; ++v) {
+        int last = graph.lastArc(v);
+        for (int a = graph.firstArc(v); a < last; ++a) {
+            // A binary network may link the same pair twice; a matrix cannot
+            int& link = linkTo[graph.arcTarget(a)];
+            if (link >= 0) {
+                removed.push_back(link);
+            }
+            link = graph.arcEdge(a);
+        }
+
+        for (; next < edges.size() && edges[next].source == v; ++next) {
+            const RoutingEdge& link = edges[next];
+
+            int e = linkTo[link.target];
+            if (e < 0) {
+                added.push_back(link);
+            } else if (graph.edge(e).weight != link.weight) {
+                reweighted.push_back(std::make_pair(e, link.weight));
+            }
+            linkTo[link.target] = -1;
+        }
+
+        // Whatever the row no longer mentions has gone
+        for (int a = graph.firstArc(v); a < last; ++a) {
+            int target = graph.arcTarget(a);
+            if (linkTo[target] >= 0) {
+                removed.push_back(linkTo[target]);
+                linkTo[target] = -1;
             }
         }
     }
 
-    // Parse the final line of the description: the start/end nodes
-    QStringList nodes = lines[lines.length() - 1].split(QRegExp("\\s+"),
-        QString::SkipEmptyParts);
-    if (nodes.length() != 2) {
-        postWarningMessage("Start and end nodes line is malformed; "
-            "routing will not take place.");
-        result |= WarningBadStartEnd;
+    int result = Success;
+    for (size_t i = 0; i < spec.badCells().size(); ++i) {
+        postBadCellMessage(spec.badCells()[i]);
+        result |= WarningBadCell;
+    }
+
+    // The edits are made as one change, without the per-edit repairs and
+    // reports of editing by hand; the route is brought up to date once,
+    // after the start/end lines have been looked at
+    QElapsedTimer timer;
+    timer.start();
+    stopAlternatives();
+    for (size_t i = 0; i < reweighted.size(); ++i) {
+        changeEdgeWeight(m_graphEdges[reweighted[i].first],
+            reweighted[i].second);
+    }
+    for (size_t i = 0; i < removed.size(); ++i) {
+        deleteEdge(m_graphEdges[removed[i]]);
+    }
+    for (size_t i = 0; i < added.size(); ++i) {
+        insertEdge(added[i].source, added[i].target, added[i].weight);
+    }
+
+    size_t changes = reweighted.size() + removed.size() + added.size();
+    if (changes == 0) {
+        postInfoMessage("The links are unchanged.");
     } else {
-        QString startNodeName = nodes[0];
-        QString endNodeName   = nodes[1];
+        discardRoutingTable();
+        m_treeCache.invalidate();
+        postSuccessMessage(QString("Patched the network in place: %1 links "
+            "re-weighted, %2 removed and %3 added in %4 ms.")
+                .arg(reweighted.size())
+                .arg(removed.size())
+                .arg(added.size())
+                .arg(timer.elapsed()));
+    }
 
-        m_routeStart = m_graphNodes[startNodeName];
-        m_routeEnd   = m_graphNodes[endNodeName];
+    // The start/end lines may have changed too
+    NetworkModel::StageResult parsed;
+    std::vector<RouteQuery>   queries;
+    for (size_t i = 0; i < spec.queryLines().size(); ++i) {
+        RouteQuery query;
 
-        if (!m_routeStart) {
-            postWarningMessage(QString("Failed to find start node '%1'; "
-                "routing will not take place.")
-                    .arg(startNodeName));
-            result |= WarningNoStartNode;
+        int queryResult = NetworkModel::parseRouteQuery(spec.queryLines()[i],
+            m_network.names(), query, parsed);
+        if (queryResult == Success) {
+            queries.push_back(query);
+        }
+        result |= queryResult;
+    }
+    postStage(parsed);
+
+    bool moved = result != Success || !m_routeStart ||
+        queries[0].source != m_routeStart->data(VertexIndexKey).toInt() ||
+        queries[0].target != m_routeEnd->data(VertexIndexKey).toInt();
+    const std::vector<RouteQuery>& old = m_network.queries();
+    bool batchChanged = queries.size() != old.size();
+    for (size_t i = 0; !batchChanged && i < queries.size(); ++i) {
+        batchChanged = queries[i].source != old[i].source ||
+                       queries[i].target != old[i].target;
+    }
+    m_network.swapQueries(queries);
+
+    // A new first pair needs a new route; otherwise the route is read from
+    // one fresh tree, and only the batch is stale
+    if (moved) {
+        routeFirstQuery(result);
+    } else if (changes > 0 || batchChanged) {
+        int source = m_routeStart->data(VertexIndexKey).toInt();
+        if (changes > 0 && !showTreeRoute(m_treeCache.tree(source))) {
+            postWarningMessage(QString("Node %1 can no longer be reached "
+                "from node %2.")
+                    .arg(m_routeEnd->text())
+                    .arg(m_routeStart->text()));
         }
 
-        if (!m_routeEnd) {
-            postWarningMessage(QString("Failed to find end node '%1'; "
-                "routing will not take place.")
-                    .arg(endNodeName));
-            result |= WarningNoEndNode;
+        m_network.clearBatch();
+        if (m_network.queries().size() > 1) {
+            routeBatch();
         }
     }
 
-    // Graph was built successfully, even if some parsing errors arose.
-    return result;
+    return true;
 }
 
-void MainWindow::routeNetwork()
+void MainWindow::restoreSession(const SessionFile& session)
 {
-    // Storage class for the metadata required by Dijkstra
-    struct MetaData {
-        int         distance;
-        EdgeItem*   edge;
-        NodeItem*   previous;
-        NodeItem*   owner;
+    // Put every node back where it was
+    std::pair<DigraphVertexIterator, DigraphVertexIterator> iterators =
+        boost::vertices(m_graph);
+    DigraphVertexIterator it = iterators.first;
+    for (; it != iterators.second; ++it) {
+        int v = static_cast<int>(*it);
+        m_graph[*it].item->setPos(session.x(v), session.y(v));
+    }
 
-        MetaData()
-            : distance(INT_MAX)
-            , edge(nullptr)
-            , previous(nullptr)
-            , owner(nullptr)
-        {
+    m_controlsDock->enableClearNetwork(true);
+    m_controlsDock->enableRoutingTable(true);
+    m_controlsDock->enableLinkEditing(true);
+    m_controlsDock->enableGraphLayoutOptions(true);
+    m_controlsDock->setRoutingAlgorithm(session.algorithm());
+
+    // The route is taken as it was drawn rather than searched for again
+    if (session.routeSource() >= 0) {
+        m_routeStart = m_graph[
+            boost::vertex(session.routeSource(), m_graph)].item;
+        m_routeEnd   = m_graph[
+            boost::vertex(session.routeTarget(), m_graph)].item;
+
+        for (int i = 0; i < session.routeLength(); ++i) {
+            m_route.append(m_graphEdges[session.routeEdge(i)]);
         }
 
-        MetaData(NodeItem* owner_)
-            : distance(INT_MAX)
-            , edge(nullptr)
-            , previous(nullptr)
-            , owner(owner_)
-        {
+        m_controlsDock->enableGraphDisplayOptions(true);
+        m_controlsDock->enableGenerateReport(true);
+    }
+
+    unsigned style = session.style();
+    m_controlsDock->setHighlightOptions(
+        (style & SessionFile::HighlightStart) != 0,
+        (style & SessionFile::HighlightEnd) != 0,
+        (style & SessionFile::HighlightPath) != 0);
+    setHighlightStartNode(m_controlsDock->highlightStartNode());
+    setHighlightEndNode(m_controlsDock->highlightEndNode());
+    setHighlightPath(m_controlsDock->highlightPath());
+}
+
+bool MainWindow::discardNetwork()
+{
+    if (boost::num_vertices(m_graph) == 0) {
+        return true;
+    }
+
+    postWarningMessage("Existing network already loaded; must be cleared "
+        "in order to continue.");
+
+    int response = QMessageBox::question(this, "NetRoute", "There is "
+        "already a graph in the explorer; the current data will have to "
+        "be discared.  Continue?");
+    if (response == QMessageBox::No) {
+        postErrorMessage("Aborted by user.");
+        return false;
+    }
+
+    postInfoMessage("Discarding network.");
+    clearNetwork();
+    return true;
+}
+
+void MainWindow::createNetwork(const Continuation& finished)
+{
+    const RoutingGraph& graph = m_network.graph();
+
+    // The scene is filled a batch at a time, with the view held still until
+    // done; it counts as a job, so it shows progress and can be stopped
+    postInfoMessage(QString("Creating %1 nodes...").arg(graph.vertexCount()));
+    postInfoMessage(QString("Creating %1 edges from adjacency matrix...")
+        .arg(graph.edgeCount()));
+
+    m_sceneItemCount = 0;
+    m_sceneFinished  = finished;
+    m_jobProgress.reset();
+    m_jobProgress.setTotal(graph.vertexCount() + graph.edgeCount());
+    announceJob("Drawing the network");
+
+    m_graphView->setUpdatesEnabled(false);
+    m_sceneTimer->start();
+}
+
+void MainWindow::createSceneItems()
+{
+    const RoutingGraph& graph     = m_network.graph();
+    int                 nodeCount = graph.vertexCount();
+    int                 itemCount = nodeCount + graph.edgeCount();
+    int                 first     = m_sceneItemCount;
+    int                 last      = qMin(first + SceneBatchSize, itemCount);
+
+    // The nodes go first; the routing graph is in row-major order, and the
+    // edge items take the same indices
+    for (; m_sceneItemCount < last; ++m_sceneItemCount) {
+        if (m_sceneItemCount < nodeCount) {
+            int       i    = m_sceneItemCount;
+            NodeItem* node = new NodeItem;
+            node->setText(nodeName(i));
+            node->setData(VertexIndexKey, i);
+            connect(node, &NodeItem::nodeItemDoubleClicked, this,
+                &MainWindow::routeToNode);
+
+            boost::add_vertex(NodeProperties(node), m_graph);
+
+            m_graphScene->addItem(node);
+        } else {
+            const RoutingEdge& edge = graph.edge(m_sceneItemCount - nodeCount);
+            createEdge(edge.source, edge.target, edge.weight);
         }
-    };
+    }
+    m_jobProgress.advance(last - first);
+    if (m_sceneItemCount < itemCount) {
+        return;
+    }
 
-    QMap<NodeItem*, MetaData>   metadata;
-    QList<NodeItem*>            nodes;
-    NodeItem*                   current;
+    m_sceneTimer->stop();
+    m_graphView->setUpdatesEnabled(true);
+    hideJobProgress();
+
+    m_boostRouter.setGraph(&m_graph);
+    m_treeCache.setGraph(&graph);
+
+    Continuation finished;
+    finished.swap(m_sceneFinished);
+    if (finished) {
+        finished();
+    }
+}
+
+void MainWindow::postBadCellMessage(const SpecParser::BadCell& cell)
+{
+    postWarningMessage(QString("Weight (%1,%2) is malformed: %3.")
+        .arg(cell.row)
+        .arg(cell.column)
+        .arg(QString::fromUtf8(cell.text.c_str())));
+}
+
+EdgeItem* MainWindow::createEdge(int start, int end, int weight)
+{
+    DigraphVertex vStart = boost::vertex(start, m_graph);
+    DigraphVertex vEnd   = boost::vertex(end, m_graph);
+
+    // Create the new edge item
+    EdgeItem* edge = new EdgeItem;
+    edge->setStartNode(m_graph[vStart].item);
+    edge->setEndNode(m_graph[vEnd].item);
+    edge->setWeight(weight);
+    edge->setData(EdgeIndexKey, m_graphEdges.size());
+    m_graphScene->addItem(edge);
+    m_graphEdges.append(edge);
+
+    // Add it to the graph
+    boost::add_edge(vStart, vEnd, EdgeProperties(edge, weight), m_graph);
+
+    return edge;
+}
+
+void MainWindow::routeNetwork()
+{
+    int source = m_routeStart->data(VertexIndexKey).toInt();
+    int target = m_routeEnd->data(VertexIndexKey).toInt();
+
+    NetworkModel::RouteOptions options;
+    options.algorithm     = m_controlsDock->routingAlgorithm();
+    options.landmarkCount = m_controlsDock->landmarkCount();
+    options.pathCount     = m_controlsDock->pathCount();
+    options.bucketWidth   = m_controlsDock->bucketWidth();
 
-    // Initialise data-structres
     postInfoMessage("Preparing to route...");
-    {
-        QMapIterator<QString, NodeItem*> i(m_graphNodes);
-        while (i.hasNext()) {
-            auto item = i.next();
-
-            // Initialise the metadata
-            MetaData md(item.value());
-            if (item.value() == m_routeStart) {
-                // Need minimal distance for the start node
-                md.distance = 0;
-            }
-            metadata[i.value()] = md;
+    stopAlternatives();
+    m_route.clear();
 
-            // Initialise the node list
-            nodes.append(i.value());
+    // The search, Boost.Graph's for comparison and any batch all run off
+    // the GUI thread; the scene is only touched once they are done
+    std::shared_ptr<qint64> boostTime(new qint64(0));
+    runJob("Routing", [this, source, target, options, boostTime] () {
+        m_network.route(source, target, options, &m_threadPool);
+        if (m_jobProgress.isCancelled()) {
+            return;
         }
-    }
 
-    // Dijkstra's algorithm: calculate all the distances
-    while (!nodes.isEmpty()) {
-        // Find node with smallest distance
-        {
-            int d = INT_MAX;
-            auto elem = nodes.end();
-            for (auto it = nodes.begin(); it != nodes.end(); ++it) {
-                int thisDistance = metadata[*it].distance;
-                if (thisDistance < d) {
-                    d    = thisDistance;
-                    elem = it;
-                }
-            }
+        if (options.algorithm == BoostRouting) {
+            QElapsedTimer timer;
+            timer.start();
+            m_boostRouter.route(source, target);
+            *boostTime = timer.nsecsElapsed();
+        }
+        if (m_network.queries().size() > 1) {
+            m_network.routeBatch(&m_threadPool);
+        }
+    }, [this, target, options, boostTime] () {
+        const NetworkModel::StageResult& routed = m_network.routeResult();
+        postStage(routed);
+        if (routed.result == NetworkModel::ErrorCancelled) {
+            return;
+        }
 
-            current = *elem;
+        if (options.algorithm == BoostRouting) {
+            // Boost.Graph's own Dijkstra over the explorer's graph, run
+            // against the model's for comparison
+            qint64 ownTime = routed.nanoseconds;
+
+            postInfoMessage(QString("Boost.Graph took %1 us; %2 took %3 us "
+                "(%4x).")
+                    .arg(*boostTime / 1000.0, 0, 'f', 1)
+                    .arg(m_network.usedDenseMatrix() ? "DenseDijkstraEngine" :
+                                                       "DijkstraEngine")
+                    .arg(ownTime / 1000.0, 0, 'f', 1)
+                    .arg(*boostTime / qMax<double>(ownTime, 1), 0, 'f', 2));
+            if (m_boostRouter.distance(target) != m_network.routeDistance()) {
+                postWarningMessage(QString("Engines disagree on the cost: %1 "
+                    "against %2.")
+                        .arg(m_boostRouter.distance(target))
+                        .arg(m_network.routeDistance()));
+            }
+        }
 
-            // If we hit the target, we can stop
-            if (current == m_routeEnd) {
-                postInfoMessage("Search complete; reached target node!");
-                break;
-            } else {
-                // Emshrinken the list
-                nodes.erase(elem);
+        if (routed.result == NetworkModel::Success) {
+            // Map the edge indices of the route back onto the scene; the
+            // Boost.Graph option draws the route Boost.Graph found
+            postInfoMessage("Back-tracking to construct route...");
+            std::vector<int> path = options.algorithm == BoostRouting ?
+                m_boostRouter.path(target) : m_network.routePath();
+            for (size_t i = 0; i < path.size(); ++i) {
+                m_route.append(m_graphEdges[path[i]]);
             }
         }
 
-        postInfoMessage(QString("Considering node %1...")
-                .arg(current->text()));
+        // Take turns showing the alternatives
+        if (m_network.alternatives().pathCount() > 1) {
+            postInfoMessage(QString("Found %1 loopless routes; highlighting "
+                "each in turn.")
+                    .arg(m_network.alternatives().pathCount()));
+            m_alternativeShown = 0;
+            m_alternativeTimer->start();
+        }
+
+        // Any further start/end pairs were solved together
+        if (m_network.queries().size() > 1) {
+            postStage(m_network.batchResult());
+        }
 
-        // Visit the neighbours
-        QListIterator<EdgeItem*> i(current->edges());
-        while (i.hasNext()) {
-            EdgeItem* edge      = i.next();
-            NodeItem* neighbour = edge->endNode();
-            int       dist      = metadata[current].distance + edge->weight();
+        // All done!
+        postSuccessMessage("Routing complete!");
 
-            if (dist < metadata[neighbour].distance) {
-                metadata[neighbour].distance = dist;
-                metadata[neighbour].edge     = edge;
-                metadata[neighbour].previous = current;
-            }
+        // Update the display
+        setHighlightStartNode(m_controlsDock->highlightStartNode());
+        setHighlightEndNode(m_controlsDock->highlightEndNode());
+        setHighlightPath(m_controlsDock->highlightPath());
+    });
+}
+
+void MainWindow::routeBatch()
+{
+    runJob("Routing batch", [this] () {
+        m_network.routeBatch(&m_threadPool);
+    }, [this] () {
+        postStage(m_network.batchResult());
+    });
+}
+
+void MainWindow::editLink()
+{
+    cancelJob();
+
+    QString startName = m_controlsDock->linkStart();
+    QString endName   = m_controlsDock->linkEnd();
+    int     weight    = m_controlsDock->linkWeight();
+    whenIdle([this, startName, endName, weight] () {
+        applyLinkEdit(startName, endName, weight);
+    });
+}
+
+void MainWindow::applyLinkEdit(const QString& startName,
+    const QString& endName, int weight)
+{
+    int start = m_network.names().resolve(startName.toStdString());
+    int end   = m_network.names().resolve(endName.toStdString());
+    if (start < 0 || end < 0) {
+        postErrorMessage(QString("Failed to find node '%1'.")
+            .arg(start < 0 ? startName : endName));
+        return;
+    }
+
+    NodeItem* startNode = m_graph[boost::vertex(start, m_graph)].item;
+    NodeItem* endNode   = m_graph[boost::vertex(end, m_graph)].item;
+
+    // Find the existing link, if there is one
+    EdgeItem* link = nullptr;
+    QListIterator<EdgeItem*> i(startNode->edges());
+    while (i.hasNext() && !link) {
+        EdgeItem* edge = i.next();
+        if (edge->startNode() == startNode && edge->endNode() == endNode) {
+            link = edge;
         }
     }
 
-    // Walk backwards from the target to the source, building the path
-    postInfoMessage("Back-tracking to construct route...");
-    for (current = m_routeEnd; current; current = metadata[current].previous) {
-        EdgeItem* edge = metadata[current].edge;
+    // A negative weight means no link, as in the specification
+    if (weight < 0) {
+        if (!link) {
+            postWarningMessage(QString("There is no link from %1 to %2.")
+                .arg(startNode->text())
+                .arg(endNode->text()));
+            return;
+        }
 
-        if (edge) {
-            m_route.prepend(edge);
+        postInfoMessage(QString("Removing link from %1 to %2...")
+            .arg(startNode->text())
+            .arg(endNode->text()));
+        removeEdge(link);
+    } else if (link) {
+        postInfoMessage(QString("Changing weight of link from %1 to %2 "
+            "from %3 to %4...")
+                .arg(startNode->text())
+                .arg(endNode->text())
+                .arg(link->weight())
+                .arg(weight));
+        setEdgeWeight(link, weight);
+    } else {
+        postInfoMessage(QString("Adding link from %1 to %2 with weight %3...")
+            .arg(startNode->text())
+            .arg(endNode->text())
+            .arg(weight));
+        addEdge(startNode, endNode, weight);
+    }
+}
+
+void MainWindow::setEdgeWeight(EdgeItem* edge, int weight)
+{
+    int e   = edge->data(EdgeIndexKey).toInt();
+    int old = edge->weight();
+    if (weight == old) {
+        return;
+    }
+
+    // Nothing may be left pointing at the alternatives the model drops
+    stopAlternatives();
+    changeEdgeWeight(edge, weight);
+    networkEdited(e, weight < old);
+}
+
+EdgeItem* MainWindow::addEdge(NodeItem* start, NodeItem* end, int weight)
+{
+    stopAlternatives();
+
+    EdgeItem* edge = insertEdge(start->data(VertexIndexKey).toInt(),
+        end->data(VertexIndexKey).toInt(), weight);
+    networkEdited(edge->data(EdgeIndexKey).toInt(), true);
+    return edge;
+}
+
+void MainWindow::removeEdge(EdgeItem* edge)
+{
+    int e = edge->data(EdgeIndexKey).toInt();
+
+    // Nothing may be left pointing at the item
+    stopAlternatives();
+    deleteEdge(edge);
+    networkEdited(e, false);
+}
+
+void MainWindow::changeEdgeWeight(EdgeItem* edge, int weight)
+{
+    int e = edge->data(EdgeIndexKey).toInt();
+
+    edge->setWeight(weight);
+    edge->update();
+    m_network.setEdgeWeight(e, weight);
+
+    // Boost.Graph routes on the edge property, so keep that in step too
+    DigraphVertex vStart = boost::vertex(
+        edge->startNode()->data(VertexIndexKey).toInt(), m_graph);
+    std::pair<Digraph::out_edge_iterator, Digraph::out_edge_iterator> outEdges
+        = boost::out_edges(vStart, m_graph);
+    for (Digraph::out_edge_iterator it = outEdges.first;
+            it != outEdges.second; ++it) {
+        if (m_graph[*it].item == edge) {
+            m_graph[*it].weight = weight;
         }
     }
+}
+
+EdgeItem* MainWindow::insertEdge(int source, int target, int weight)
+{
+    // Both number their edges in creation order, so the indices agree
+    int       e    = m_network.addEdge(source, target, weight);
+    EdgeItem* edge = createEdge(source, target, weight);
+    Q_ASSERT(edge->data(EdgeIndexKey).toInt() == e);
+    Q_UNUSED(e);
+
+    return edge;
+}
+
+void MainWindow::deleteEdge(EdgeItem* edge)
+{
+    int e = edge->data(EdgeIndexKey).toInt();
+
+    // Take it out of the graphs; its index is not reused
+    m_network.removeEdge(e);
+    m_graphEdges[e] = nullptr;
+    boost::remove_out_edge_if(
+        boost::vertex(edge->startNode()->data(VertexIndexKey).toInt(), m_graph),
+        [this, edge] (Digraph::edge_descriptor d) {
+            return m_graph[d].item == edge;
+        }, m_graph);
+
+    // ...and off the screen
+    m_route.removeAll(edge);
+    edge->setStartNode(nullptr);
+    edge->setEndNode(nullptr);
+    m_graphScene->removeItem(edge);
+    delete edge;
+}
 
-    // All done!
-    postSuccessMessage("Routing complete!");
+void MainWindow::discardRoutingTable()
+{
+    // The model has dropped what its engines precomputed; the table is ours
+    if (!m_routingTable.isEmpty()) {
+        m_routingTable.clear();
+        postInfoMessage("Routing table discarded; build it again to include "
+            "the change.");
+    }
+}
+
+void MainWindow::networkEdited(int edge, bool improved)
+{
+    discardRoutingTable();
+
+    // Only the tree in use is worth repairing; the rest of the cache goes
+    int source = m_routeStart ? m_routeStart->data(VertexIndexKey).toInt() : -1;
+    ShortestPathTree* tree = m_treeCache.find(source);
+    m_treeCache.invalidate(source);
+
+    if (!m_routeStart || !m_routeEnd) {
+        return;
+    }
+
+    int target = m_routeEnd->data(VertexIndexKey).toInt();
+    int updated;
+
+    // The first edit pays for a full tree; later ones only repair it
+    QElapsedTimer timer;
+    timer.start();
+    if (!tree) {
+        tree    = &m_treeCache.tree(source);
+        updated = m_network.graph().vertexCount();
+    } else if (improved) {
+        updated = tree->edgeImproved(edge);
+    } else {
+        updated = tree->edgeWorsened(edge);
+    }
+
+    postInfoMessage(QString("Shortest-path tree updated %1 of %2 nodes in "
+        "%3 us.")
+            .arg(updated)
+            .arg(m_network.graph().vertexCount())
+            .arg(timer.nsecsElapsed() / 1000.0, 0, 'f', 1));
+
+    if (!showTreeRoute(*tree)) {
+        postWarningMessage(QString("Node %1 can no longer be reached from "
+            "node %2.")
+                .arg(m_routeEnd->text())
+                .arg(m_routeStart->text()));
+    } else {
+        postInfoMessage(QString("Route cost is now %1.")
+            .arg(tree->distance(target)));
+    }
+}
+
+void MainWindow::routeToNode(NodeItem* node)
+{
+    cancelJob();
+
+    // Read before waiting, as it is the click that counts
+    bool moveStart = QApplication::keyboardModifiers() & Qt::ShiftModifier;
+    whenIdle([this, node, moveStart] () { moveRouteTo(node, moveStart); });
+}
+
+void MainWindow::moveRouteTo(NodeItem* node, bool moveStart)
+{
+    if (!m_routeStart || !m_routeEnd) {
+        return;
+    }
+
+    // Shift+double-click moves the start instead of the end
+    if (node == m_routeStart || (!moveStart && node == m_routeEnd)) {
+        return;
+    }
+
+    stopAlternatives();
+    if (moveStart) {
+        clearNodeStyle(m_routeStart);
+        m_routeStart->setEmphasised(false);
+        m_routeStart = node;
+    } else {
+        clearNodeStyle(m_routeEnd);
+        m_routeEnd->setEmphasised(false);
+        m_routeEnd = node;
+    }
+
+    int source = m_routeStart->data(VertexIndexKey).toInt();
+    int target = m_routeEnd->data(VertexIndexKey).toInt();
+
+    // Only a start node that is not in the cache needs a search
+    QElapsedTimer     timer;
+    bool              cached = m_treeCache.find(source) != nullptr;
+    timer.start();
+    ShortestPathTree& tree   = m_treeCache.tree(source);
+    bool              found  = showTreeRoute(tree);
+
+    postInfoMessage(QString("Route from %1 to %2 %3 in %4 us.")
+        .arg(m_routeStart->text())
+        .arg(m_routeEnd->text())
+        .arg(cached ? "read from the cached tree" : "found by a new search")
+        .arg(timer.nsecsElapsed() / 1000.0, 0, 'f', 1));
+
+    if (!found) {
+        postWarningMessage(QString("Node %1 cannot be reached from node %2.")
+            .arg(m_routeEnd->text())
+            .arg(m_routeStart->text()));
+    } else {
+        postInfoMessage(QString("Total route cost: %1")
+            .arg(tree.distance(target)));
+    }
 
-    // Update the display
     setHighlightStartNode(m_controlsDock->highlightStartNode());
     setHighlightEndNode(m_controlsDock->highlightEndNode());
+}
+
+bool MainWindow::showTreeRoute(const ShortestPathTree& tree)
+{
+    int target = m_routeEnd->data(VertexIndexKey).toInt();
+
+    // Swap the highlighted route for the one in the tree
+    QListIterator<EdgeItem*> i(m_route);
+    while (i.hasNext()) {
+        i.next()->setEmphasised(false);
+    }
+    m_route.clear();
+
+    if (tree.isReached(target)) {
+        std::vector<int> path = tree.path(target);
+        for (size_t e = 0; e < path.size(); ++e) {
+            m_route.append(m_graphEdges[path[e]]);
+        }
+    }
+
     setHighlightPath(m_controlsDock->highlightPath());
+    return tree.isReached(target);
 }
 
 void MainWindow::clearNetwork()
 {
+    cancelJob();
+    whenIdle([this] () { removeNetwork(); });
+}
+
+void MainWindow::removeNetwork()
+{
+    // Stop cycling through items that are about to be deleted
+    stopAlternatives();
+    watchSpecFile(QString());
+
     // Clear the graph datastructures
     m_graph.clear();
     m_graphScene->clear();
-    m_graphNodes.clear();
+    m_graphEdges.clear();
+    m_boostRouter.setGraph(nullptr);
+    m_treeCache.setGraph(nullptr);
+    m_routingTable.clear();
+    m_network.clear();
 
     // Clear the route-related stuff
     m_route.clear();
@@ -626,32 +1792,92 @@ void MainWindow::clearNetwork()
 
     // Update the UI
     m_controlsDock->enableClearNetwork(false);
+    m_controlsDock->enableRoutingTable(false);
+    m_controlsDock->enableLinkEditing(false);
     m_controlsDock->enableGenerateReport(false);
     m_controlsDock->enableGraphDisplayOptions(false);
     m_controlsDock->enableGraphLayoutOptions(false);
 }
 
+void MainWindow::buildRoutingTable()
+{
+    cancelJob();
+
+    postInfoMessage(QString("Building all-pairs routing table using %1 "
+        "threads...")
+            .arg(m_threadPool.threadCount()));
+
+    std::shared_ptr<RoutingTable::Status> status(
+        new RoutingTable::Status(RoutingTable::Built));
+    std::shared_ptr<qint64> elapsed(new qint64(0));
+    runJob("Building routing table", [this, status, elapsed] () {
+        QElapsedTimer timer;
+        timer.start();
+        *status  = m_routingTable.build(m_network.graph(), &m_threadPool,
+            &m_jobProgress);
+        *elapsed = timer.elapsed();
+    }, [this, status, elapsed] () {
+        switch (*status) {
+        case RoutingTable::Built:
+            postSuccessMessage(QString("Routing table for %1 nodes built in "
+                "%2 ms.")
+                    .arg(m_routingTable.vertexCount())
+                    .arg(*elapsed));
+            m_controlsDock->enableGenerateReport(true);
+            break;
+
+        case RoutingTable::TooManyNodes:
+            // Floyd-Warshall is cubic in the node count, the table quadratic
+            postErrorMessage(QString("A routing table for %1 nodes would be "
+                "too big; the limit is %2 nodes.")
+                    .arg(m_network.graph().vertexCount())
+                    .arg(RoutingTable::MaxVertexCount));
+            break;
+
+        case RoutingTable::CostTooLarge:
+            postErrorMessage(QString("Some routes cost %1 or more, which "
+                "the routing table cannot hold; no table was built.")
+                    .arg(RoutingTable::CostLimit));
+            break;
+
+        case RoutingTable::Cancelled:
+            postWarningMessage("Routing table cancelled.");
+            break;
+        }
+    });
+}
+
 void MainWindow::generateRouteReport()
 {
-    int     totalCost = 0;
-    QString route;
+    cancelJob();
+    whenIdle([this] () { reportRoute(); });
+}
+
+void MainWindow::reportRoute()
+{
+    int              totalCost = 0;
+    std::vector<int> path;
+
+    // The all-pairs table stands on its own
+    if (!m_routingTable.isEmpty()) {
+        reportRoutingTable();
+    }
 
     // Check a route actually exists
     if (m_route.isEmpty() || !m_routeStart || !m_routeEnd) {
-        postErrorMessage("Route has not been built.");
+        if (m_routingTable.isEmpty()) {
+            postErrorMessage("Route has not been built.");
+        }
         return;
     }
 
-    // Seed the route with the start node
-    route = m_routeStart->text();
-
     // Iterate over the route list updating the variables above
     QListIterator<EdgeItem*> i(m_route);
     while (i.hasNext()) {
         EdgeItem* edge = i.next();
 
-        // Add the target to the route
-        route += edge->endNode()->text();
+        // Add the edge to the route
+        path.push_back(edge->data(EdgeIndexKey).toInt());
 
         // Update the cost
         totalCost += edge->weight();
@@ -659,7 +1885,155 @@ void MainWindow::generateRouteReport()
 
     // Print the result
     postInfoMessage(QString("Total route cost: %1").arg(totalCost));
-    postInfoMessage(QString("Route taken:      %1").arg(route));
+    postInfoMessage(QString("Route taken:      %1")
+        .arg(routeText(m_routeStart->data(VertexIndexKey).toInt(), path)));
+
+    // List the alternatives, then the rest of the batch
+    if (m_network.alternatives().pathCount() > 1) {
+        reportAlternatives();
+    }
+    if (!m_network.batch().isEmpty()) {
+        reportBatch();
+    }
+}
+
+void MainWindow::reportRoutingTable()
+{
+    // Keep the transcript readable for big networks
+    static const int MaxReportedNodes = 64;
+
+    int count = qMin(m_routingTable.vertexCount(), MaxReportedNodes);
+
+    postInfoMessage("Routing table (destination: next hop/total cost):");
+    for (int from = 0; from < count; ++from) {
+        QStringList entries;
+
+        for (int to = 0; to < count; ++to) {
+            if (to == from) {
+                continue;
+            }
+
+            int hop = m_routingTable.nextHop(from, to);
+            if (hop < 0) {
+                entries << QString("%1: -").arg(nodeName(to));
+            } else {
+                entries << QString("%1: %2/%3")
+                    .arg(nodeName(to))
+                    .arg(nodeName(hop))
+                    .arg(m_routingTable.distance(from, to));
+            }
+        }
+
+        postInfoMessage(QString("%1 | %2")
+            .arg(nodeName(from))
+            .arg(entries.join(", ")));
+    }
+
+    if (count < m_routingTable.vertexCount()) {
+        postInfoMessage(QString("Routing table truncated to the first %1 of "
+            "%2 nodes.")
+                .arg(count)
+                .arg(m_routingTable.vertexCount()));
+    }
+}
+
+void MainWindow::reportBatch()
+{
+    const BatchRouter& batch     = m_network.batch();
+    qint64             batchTime = m_network.batchResult().nanoseconds;
+
+    postInfoMessage(QString("Batch of %1 queries (start -> end: cost, route):")
+        .arg(batch.queryCount()));
+
+    for (int i = 0; i < batch.queryCount(); ++i) {
+        const RouteQuery&  query  = batch.query(i);
+        const RouteResult& result = batch.result(i);
+
+        QString entry = QString("%1 -> %2: ")
+            .arg(nodeName(query.source))
+            .arg(nodeName(query.target));
+
+        if (result.distance == Unreachable) {
+            entry += "unreachable";
+        } else {
+            entry += QString("%1, %2")
+                .arg(result.distance)
+                .arg(routeText(query.source, result.path));
+        }
+
+        postInfoMessage(entry);
+    }
+
+    postInfoMessage(QString("Throughput: %1 queries/s on %2 threads.")
+        .arg(batch.queryCount() * 1e9 / qMax<qint64>(batchTime, 1), 0, 'f', 0)
+        .arg(m_threadPool.threadCount()));
+}
+
+void MainWindow::reportAlternatives()
+{
+    const KShortestPaths& alternatives = m_network.alternatives();
+    int                   source = m_routeStart->data(VertexIndexKey).toInt();
+
+    postInfoMessage(QString("%1 cheapest loopless routes (cost, route):")
+        .arg(alternatives.pathCount()));
+    for (int i = 0; i < alternatives.pathCount(); ++i) {
+        postInfoMessage(QString("%1: %2, %3")
+            .arg(i + 1)
+            .arg(alternatives.cost(i))
+            .arg(routeText(source, alternatives.path(i))));
+    }
+}
+
+void MainWindow::stopAlternatives()
+{
+    if (m_alternativeTimer->isActive()) {
+        m_alternativeTimer->stop();
+        setAlternativeEmphasised(m_alternativeShown, false);
+        setHighlightPath(m_highlightPath);
+    }
+
+    m_network.clearAlternatives();
+    m_alternativeShown = 0;
+}
+
+void MainWindow::showNextAlternative()
+{
+    // Take the current route down, then put the next one up
+    setAlternativeEmphasised(m_alternativeShown, false);
+    m_alternativeShown = (m_alternativeShown + 1) %
+        m_network.alternatives().pathCount();
+    setAlternativeEmphasised(m_alternativeShown, true);
+}
+
+void MainWindow::setAlternativeEmphasised(int i, bool emphasised)
+{
+    // The best route keeps the usual colour; the others are drawn in amber
+    QPen pen(QBrush(QColor(255, 170, 0, 96)), 12.0f, Qt::SolidLine,
+        Qt::RoundCap);
+
+    const std::vector<int>& path = m_network.alternatives().path(i);
+    for (size_t e = 0; e < path.size(); ++e) {
+        EdgeItem* edge = m_graphEdges[path[e]];
+
+        if (emphasised && i > 0) {
+            edge->setEmphasisPen(pen);
+        } else {
+            edge->resetEmphasisPen();
+        }
+        edge->setEmphasised(emphasised && m_highlightPath);
+    }
+}
+
+QString MainWindow::nodeName(int vertex) const
+{
+    return QString::fromStdString(m_network.names().name(vertex));
+}
+
+QString MainWindow::routeText(int source, const std::vector<int>& path) const
+{
+    // Same notation as the main route and the batch report
+    return QString::fromStdString(NetworkModel::routeText(m_network.graph(),
+        m_network.names(), source, path));
 }
 
 // Graph appearance stuff
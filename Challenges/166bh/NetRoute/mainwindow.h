@@ -8,17 +8,35 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <functional>
+
+#include <QtCore/QFile>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QList>
 #include <QtCore/QMap>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
 #include <QtWidgets/QGraphicsScene>
 #include <QtWidgets/QGraphicsView>
 #include <QtWidgets/QMainWindow>
+#include <QtWidgets/QProgressBar>
 #include <QtWidgets/QTextEdit>
+#include <QtWidgets/QToolButton>
 
 #include "controlsdockwidget.h"
 #include "ui_mainwindow.h"
 
 #include "graph.h"
+#include "boostdijkstraengine.h"
+#include "jobprogress.h"
+#include "networkfile.h"
+#include "networkmodel.h"
+#include "routingtable.h"
+#include "sessionfile.h"
+#include "specparser.h"
+#include "threadpool.h"
+#include "treecache.h"
 
 class NodeItem;
 class EdgeItem;
@@ -28,21 +46,35 @@ class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
-    typedef QMap<QString, NodeItem*>    NamedNodeMap;
     typedef QList<EdgeItem*>            EdgeList;
+    typedef QVector<EdgeItem*>          IndexedEdgeList;
+    typedef std::function<void ()>      Continuation;
+    typedef std::function<void (int)>   BuildFinished;
+    typedef QFutureWatcher<void>        JobWatcher;
+
+    // A specification or network file read off the GUI thread
+    struct LoadedFile;
 
+    // The model's load results, plus the user backing out of a load
     enum ReturnCodes {
-        Success             =  0,
+        Success             = NetworkModel::Success,
 
-        ErrorEmpty          = -1,
-        ErrorSpecTooSmall   = -2,
-        ErrorRowTooShort    = -3,
+        ErrorEmpty          = NetworkModel::ErrorEmpty,
+        ErrorSpecTooSmall   = NetworkModel::ErrorSpecTooSmall,
+        ErrorRowTooShort    = NetworkModel::ErrorRowTooShort,
+        ErrorBadNodeNames   = NetworkModel::ErrorBadNodeNames,
 
         WarningAbort        = 0x01,
-        WarningBadCell      = 0x02,
-        WarningBadStartEnd  = 0x04,
-        WarningNoStartNode  = 0x08,
-        WarningNoEndNode    = 0x10,
+        WarningBadCell      = NetworkModel::WarningBadCell,
+        WarningBadStartEnd  = NetworkModel::WarningBadStartEnd,
+        WarningNoStartNode  = NetworkModel::WarningNoStartNode,
+        WarningNoEndNode    = NetworkModel::WarningNoEndNode,
+    };
+
+    enum LayoutStyle {
+        SpringLayout,
+        ForceLayout,
+        MultilevelLayout,
     };
 
 public:
@@ -69,17 +101,84 @@ public slots:
     // Graph layout stuff
     void applyRandomLayout();
     void applySpringLayout();
+    void applyForceLayout();
+    void applyMultilevelLayout();
 
     // Network specification stuff
     void parseAndRouteNetwork(const QString& description);
+    void loadAndRouteNetwork(const QString& fileName);
+    void convertNetworkFile(const QString& specName,
+                            const QString& networkName);
+    void saveSession(const QString& fileName);
     void clearNetwork();
+    void buildRoutingTable();
     void generateRouteReport();
 
+    // Network editing; the route is repaired rather than recomputed.  The
+    // edits touch the model, so they are only made while no job is running.
+    void editLink();
+    void setEdgeWeight(EdgeItem* edge, int weight);
+    EdgeItem* addEdge(NodeItem* start, NodeItem* end, int weight);
+    void removeEdge(EdgeItem* edge);
+
+    // Interactive routing from the cached shortest-path trees
+    void routeToNode(NodeItem* node);
+
+private slots:
+    void showNextAlternative();
+    void specFileChanged(const QString& fileName);
+    void reloadSpecFile();
+
 private:
-    int  buildNetwork(const QString& description);
+    void runJob(const QString& name, const Continuation& work,
+        const Continuation& finished);
+    void startJob();
+    bool stopJob();
+    void cancelJob();
+    void whenIdle(const Continuation& action);
+    void jobFinished();
+    void announceJob(const QString& name);
+    void showJobProgress();
+    void hideJobProgress();
+    bool mapFile(QFile& file, const char*& data, qint64& size);
+    void routeBuiltNetwork(int buildResult);
+    void routeFirstQuery(int buildResult);
+    bool patchNetwork(const SpecParser& spec);
+    void watchSpecFile(const QString& fileName);
+    void buildNetwork(SpecParser& spec, const BuildFinished& built);
+    void buildNetwork(const NetworkFile& network, const BuildFinished& built);
+    void restoreSession(const SessionFile& session);
+    bool discardNetwork();
+    void removeNetwork();
+    void writeSession(const QString& fileName);
+    void createNetwork(const Continuation& finished);
+    void createSceneItems();
+    void layoutNetwork(LayoutStyle style, const Continuation& finished);
+    void showLayout();
+    void postBadCellMessage(const SpecParser::BadCell& cell);
+    EdgeItem* createEdge(int start, int end, int weight);
+    void applyLinkEdit(const QString& startName, const QString& endName,
+        int weight);
+    void changeEdgeWeight(EdgeItem* edge, int weight);
+    EdgeItem* insertEdge(int source, int target, int weight);
+    void deleteEdge(EdgeItem* edge);
+    void discardRoutingTable();
+    void networkEdited(int edge, bool improved);
+    void moveRouteTo(NodeItem* node, bool moveStart);
+    bool showTreeRoute(const ShortestPathTree& tree);
     void routeNetwork();
+    void routeBatch();
+    void reportRoute();
+    void reportRoutingTable();
+    void reportBatch();
+    void reportAlternatives();
+    void stopAlternatives();
+    void setAlternativeEmphasised(int i, bool emphasised);
+    QString nodeName(int vertex) const;
+    QString routeText(int source, const std::vector<int>& path) const;
     void postMessage(const QString& htmlColour, const QString& leader,
         const QString& msg);
+    void postStage(const NetworkModel::StageResult& stage);
 
     void setStartNodeStyle(NodeItem* node);
     void setEndNodeStyle(NodeItem* node);
@@ -95,12 +194,48 @@ private:
     ControlsDockWidget* m_controlsDock;
     QTextEdit*          m_transcript;
 
-    NamedNodeMap        m_graphNodes;
+    // Everything but the drawing lives in the model
+    NetworkModel        m_network;
+    IndexedEdgeList     m_graphEdges;
+    BoostDijkstraEngine m_boostRouter;
+    RoutingTable        m_routingTable;
+    TreeCache           m_treeCache;
+    ThreadPool          m_threadPool;
+
     EdgeList            m_route;
     NodeItem*           m_routeStart;
     NodeItem*           m_routeEnd;
 
+    // Yen's routes take turns being highlighted
+    QTimer*             m_alternativeTimer;
+    int                 m_alternativeShown;
+
     bool                m_highlightPath;
+
+    // Parsing, layout and routing run off the GUI thread, one job at a time;
+    // whatever follows a job runs back on the GUI thread once it is done.  A
+    // superseded job is left to stop in the background: the job replacing
+    // it, and any changes to the model, wait until it has.
+    JobWatcher*         m_jobWatcher;
+    JobProgress         m_jobProgress;
+    QString             m_jobName;
+    Continuation        m_jobWork;
+    bool                m_jobPending;
+    Continuation        m_jobFinished;
+    QList<Continuation> m_idleActions;
+    QTimer*             m_progressTimer;
+    QProgressBar*       m_progressBar;
+    QToolButton*        m_cancelButton;
+
+    // The scene is filled a batch of items at a time between events
+    QTimer*             m_sceneTimer;
+    int                 m_sceneItemCount;
+    Continuation        m_sceneFinished;
+
+    // Specification file applied again whenever it is rewritten
+    QFileSystemWatcher* m_specWatcher;
+    QTimer*             m_reloadTimer;
+    QString             m_specFileName;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,315 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QtCore/QFile>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "routingdaemon.h"
+
+RoutingDaemon::RoutingDaemon()
+    : m_server(new QLocalServer)
+    , m_serveTimer(new QTimer)
+    , m_roundWatcher(new QFutureWatcher<void>)
+    , m_requestCount(0)
+{
+    // Requests are gathered until the event loop is idle, then served
+    m_serveTimer->setSingleShot(true);
+    m_serveTimer->setInterval(0);
+
+    QObject::connect(m_server, &QLocalServer::newConnection, m_server,
+        [this] () { acceptConnections(); });
+    QObject::connect(m_serveTimer, &QTimer::timeout, m_serveTimer,
+        [this] () { serve(); });
+    QObject::connect(m_roundWatcher, &QFutureWatcher<void>::finished,
+        m_roundWatcher, [this] () { finishRound(); });
+}
+
+RoutingDaemon::~RoutingDaemon()
+{
+    // The round in flight is using the engines
+    m_roundWatcher->waitForFinished();
+
+    delete m_roundWatcher;
+    delete m_serveTimer;
+    delete m_server;
+}
+
+bool RoutingDaemon::start(const QStringList& arguments)
+{
+    QString socketName = "netroute";
+    QString fileName;
+    int     threads    = 0;
+
+    for (int i = 0; i < arguments.size(); ++i) {
+        if (arguments[i] == "--socket" && i + 1 < arguments.size()) {
+            socketName = arguments[++i];
+        } else if (arguments[i] == "--threads" && i + 1 < arguments.size()) {
+            threads = qMax(arguments[++i].toInt(), 0);
+        } else {
+            fileName = arguments[i];
+        }
+    }
+    if (fileName.isEmpty()) {
+        fprintf(stderr, "Usage: netroute --daemon [--socket NAME] "
+            "[--threads N] network\n");
+        return false;
+    }
+
+    m_pool.reset(new ThreadPool(threads));
+    if (!load(fileName)) {
+        return false;
+    }
+    m_engines.assign(m_pool->threadCount(),
+        BidirectionalEngine(&m_network.graph()));
+
+    // A daemon that died leaves its socket behind, but one that is still
+    // answering keeps it
+    QLocalSocket probe;
+    probe.connectToServer(socketName);
+    if (probe.waitForConnected(ProbeTimeout)) {
+        fprintf(stderr, "Error: another daemon is already listening on "
+            "'%s'.\n", socketName.toLocal8Bit().constData());
+        return false;
+    }
+    QLocalServer::removeServer(socketName);
+    if (!m_server->listen(socketName)) {
+        fprintf(stderr, "Error: cannot listen on '%s': %s\n",
+            socketName.toLocal8Bit().constData(),
+            m_server->errorString().toLocal8Bit().constData());
+        return false;
+    }
+
+    fprintf(stderr, "Listening on '%s' with %d threads.\n",
+        m_server->fullServerName().toLocal8Bit().constData(),
+        m_pool->threadCount());
+    m_clock.start();
+
+    return true;
+}
+
+bool RoutingDaemon::load(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "Error: cannot open '%s': %s\n",
+            fileName.toLocal8Bit().constData(),
+            file.errorString().toLocal8Bit().constData());
+        return false;
+    }
+
+    // Loaded just as the explorer loads it, straight from a mapping
+    QElapsedTimer timer;
+    qint64        size = file.size();
+    const char*   data = size > 0 ?
+        reinterpret_cast<const char*>(file.map(0, size)) : nullptr;
+
+    timer.start();
+    if (size > 0 && !data) {
+        fprintf(stderr, "Error: cannot map '%s': %s\n",
+            fileName.toLocal8Bit().constData(),
+            file.errorString().toLocal8Bit().constData());
+        return false;
+    }
+
+    // The model's warnings and errors are worth seeing; its progress notes
+    // are not
+    int result = m_network.load(data, static_cast<size_t>(size),
+        m_pool.get());
+    const NetworkModel::StageResult& loaded = m_network.loadResult();
+    for (size_t i = 0; i < loaded.messages.size(); ++i) {
+        const NetworkModel::Message& message = loaded.messages[i];
+        if (message.type == NetworkModel::WarningMessage ||
+                message.type == NetworkModel::ErrorMessage) {
+            fprintf(stderr, "%s: %s\n",
+                message.type == NetworkModel::ErrorMessage ?
+                    "Error" : "Warning", message.text.c_str());
+        }
+    }
+    if (result < 0) {
+        fprintf(stderr, "Error: cannot load '%s'.\n",
+            fileName.toLocal8Bit().constData());
+        return false;
+    }
+
+    fprintf(stderr, "Loaded %d nodes and %d links from '%s' in %lld ms.\n",
+        m_network.graph().vertexCount(), m_network.graph().edgeCount(),
+        fileName.toLocal8Bit().constData(),
+        static_cast<long long>(timer.elapsed()));
+    return true;
+}
+
+void RoutingDaemon::acceptConnections()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        QObject::connect(socket, &QLocalSocket::readyRead, m_server,
+            [this, socket] () { readRequests(socket); });
+        QObject::connect(socket, &QLocalSocket::disconnected, socket,
+            &QObject::deleteLater);
+    }
+}
+
+void RoutingDaemon::readRequests(QLocalSocket* socket)
+{
+    while (socket->canReadLine()) {
+        Request request;
+        request.socket   = socket;
+        request.line     = socket->readLine().trimmed();
+        request.received = m_clock.nsecsElapsed();
+        if (!request.line.isEmpty()) {
+            m_pending.push_back(request);
+        }
+    }
+
+    // Without a line end in sight, the client is not speaking the protocol
+    if (socket->bytesAvailable() > MaxRequestBytes) {
+        socket->write("error request too long\n");
+        socket->disconnectFromServer();
+    }
+
+    if (!m_pending.empty() && !m_serveTimer->isActive()) {
+        m_serveTimer->start();
+    }
+}
+
+void RoutingDaemon::serve()
+{
+    // One round at a time; the next starts when this one is written back
+    if (m_roundWatcher->isRunning() || m_pending.empty()) {
+        return;
+    }
+    m_round.swap(m_pending);
+
+    m_roundWatcher->setFuture(QtConcurrent::run([this] () {
+        m_pool->parallelFor(static_cast<int>(m_round.size()),
+            [this] (int i, int thread) {
+                answer(m_round[i], thread);
+            });
+    }));
+}
+
+void RoutingDaemon::finishRound()
+{
+    std::vector<Request> round;
+    round.swap(m_round);
+
+    // Statistics cover every round before this one, so they are taken last
+    for (size_t i = 0; i < round.size(); ++i) {
+        if (round[i].line == "stats") {
+            round[i].response = stats();
+        }
+    }
+
+    // Each connection's answers go back in the order it asked
+    for (size_t i = 0; i < round.size(); ++i) {
+        if (round[i].socket) {
+            round[i].socket->write(round[i].response);
+            round[i].socket->write("\n", 1);
+        }
+    }
+
+    qint64 now = m_clock.nsecsElapsed();
+    for (size_t i = 0; i < round.size(); ++i) {
+        qint64 latency = now - round[i].received;
+        if (m_latencies.size() < LatencyWindow) {
+            m_latencies.push_back(latency);
+        } else {
+            m_latencies[m_requestCount % LatencyWindow] = latency;
+        }
+        m_requestCount += 1;
+    }
+
+    // Whatever came in while this round was answered goes next
+    serve();
+}
+
+void RoutingDaemon::answer(Request& request, int thread)
+{
+    QList<QByteArray> words   = request.line.simplified().split(' ');
+    const QByteArray& command = words[0];
+
+    if (command == "route" || command == "distance") {
+        if (words.size() != 3) {
+            request.response = "error expecting a start and an end node";
+            return;
+        }
+        routeAnswer(words, 1, thread, command == "route", request.response);
+    } else if (command == "batch") {
+        if (words.size() < 3 || words.size() % 2 == 0) {
+            request.response = "error expecting start and end node pairs";
+            return;
+        }
+
+        int pairs = (words.size() - 1) / 2;
+        request.response = "ok " + QByteArray::number(pairs);
+        for (int i = 0; i < pairs; ++i) {
+            QByteArray route;
+            routeAnswer(words, 1 + 2 * i, thread, true, route);
+            request.response += '\n' + route;
+        }
+    } else if (command != "stats" || words.size() != 1) {
+        request.response = "error unknown request '" + command + "'";
+    }
+}
+
+void RoutingDaemon::routeAnswer(const QList<QByteArray>& words, int first,
+    int thread, bool withPath, QByteArray& response)
+{
+    // Nodes may be given by name or by their numeric index
+    const SymbolTable& names  = m_network.names();
+    int                source = names.resolve(words[first].toStdString());
+    int                target = names.resolve(words[first + 1].toStdString());
+    if (source < 0 || target < 0) {
+        response = "error no node '" +
+            words[source < 0 ? first : first + 1] + "'";
+        return;
+    }
+
+    BidirectionalEngine& engine = m_engines[thread];
+    if (!engine.route(source, target)) {
+        response = "unreachable";
+        return;
+    }
+
+    response = "ok " + QByteArray::number(engine.distance());
+    if (withPath) {
+        std::vector<int> path = engine.path();
+
+        response += ' ';
+        response += names.name(source).c_str();
+        for (size_t e = 0; e < path.size(); ++e) {
+            response += ' ';
+            response += names.name(
+                m_network.graph().edge(path[e]).target).c_str();
+        }
+    }
+}
+
+QByteArray RoutingDaemon::stats() const
+{
+    std::vector<qint64> sorted(m_latencies);
+    std::sort(sorted.begin(), sorted.end());
+
+    QByteArray text = "ok requests=" + QByteArray::number(m_requestCount);
+    if (sorted.empty()) {
+        return text;
+    }
+
+    // Nearest-rank percentiles over the most recent requests, in us
+    static const int         percentiles[] = { 50, 90, 99 };
+    static const char* const names[]       = { "p50", "p90", "p99" };
+    for (int i = 0; i < 3; ++i) {
+        size_t rank = (sorted.size() * percentiles[i] + 99) / 100;
+        text += QByteArray(" ") + names[i] + "=" +
+            QByteArray::number(sorted[rank - 1] / 1000.0, 'f', 1);
+    }
+    text += " max=" + QByteArray::number(sorted.back() / 1000.0, 'f', 1);
+
+    return text;
+}
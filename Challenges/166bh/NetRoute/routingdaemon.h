@@ -0,0 +1,112 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef ROUTINGDAEMON_H
+#define ROUTINGDAEMON_H
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#include "bidirectionalengine.h"
+#include "networkmodel.h"
+#include "threadpool.h"
+
+
+// Keeps one network loaded and answers queries about it over a local socket
+// (a Unix domain socket, or a named pipe on Windows).  Run as
+//
+//     netroute --daemon [--socket NAME] [--threads N] network
+//
+// where the network is a text specification or a binary network file, loaded
+// by NetworkModel as the explorer and --batch load it.  The protocol is one
+// request per line, answered in order on each connection:
+//
+//     route START END          ok COST NODE...  | unreachable
+//     distance START END       ok COST          | unreachable
+//     batch S1 T1 S2 T2...     ok COUNT, then one route answer per pair
+//     stats                    ok requests=N p50=US p90=US p99=US max=US
+//
+// Malformed requests are answered with "error" and a reason.  Nodes may be
+// given by name or by index, as in a specification.
+//
+// Clients may pipeline requests.  Everything that has arrived when a round
+// starts is answered as one round across the thread pool, each thread with
+// its own BidirectionalEngine, and the answers are then written back in the
+// order the requests came in.  Rounds run off the event-loop thread, so
+// connections are still accepted and read while one is being answered;
+// whatever arrives meanwhile makes up the next round.  One slow request
+// therefore still holds up everything queued behind it.  Latency is
+// measured from the read to the write of each request, so it includes that
+// wait.
+class RoutingDaemon
+{
+public:
+    RoutingDaemon();
+    ~RoutingDaemon();
+
+    // Parses the arguments, loads the network and starts listening.  On
+    // failure the reason has been printed and the daemon should not be run.
+    bool start(const QStringList& arguments);
+
+private:
+    struct Request
+    {
+        QPointer<QLocalSocket>  socket;
+        QByteArray              line;
+        QByteArray              response;
+        qint64                  received;
+    };
+
+    // Longest line accepted before a client is considered broken
+    enum { MaxRequestBytes = 1 << 20 };
+
+    // Latencies kept for the percentiles
+    enum { LatencyWindow = 65536 };
+
+    // How long a daemon already on the socket has to answer, in ms
+    enum { ProbeTimeout = 1000 };
+
+    bool load(const QString& fileName);
+    void acceptConnections();
+    void readRequests(QLocalSocket* socket);
+    void serve();
+    void finishRound();
+    void answer(Request& request, int thread);
+    void routeAnswer(const QList<QByteArray>& words, int first, int thread,
+        bool withPath, QByteArray& response);
+    QByteArray stats() const;
+
+private:
+    NetworkModel                        m_network;
+
+    std::unique_ptr<ThreadPool>         m_pool;
+    std::vector<BidirectionalEngine>    m_engines;
+
+    QLocalServer*                       m_server;
+    std::vector<Request>                m_pending;
+    QTimer*                             m_serveTimer;
+
+    // The round being answered on the pool, if any
+    std::vector<Request>                m_round;
+    QFutureWatcher<void>*               m_roundWatcher;
+
+    QElapsedTimer                       m_clock;
+    std::vector<qint64>                 m_latencies;
+    qint64                              m_requestCount;
+};
+
+
+#endif  /* !ROUTINGDAEMON_H */
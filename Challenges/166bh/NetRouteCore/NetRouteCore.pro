@@ -0,0 +1,60 @@
+#-------------------------------------------------
+#
+# Routing and layout core of NetRoute, free of Qt
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+CONFIG += staticlib c++11
+CONFIG -= qt
+
+# Let the routing kernels use whatever SIMD extensions the host supports
+unix: QMAKE_CXXFLAGS_RELEASE += -march=native
+TARGET = netroutecore
+TEMPLATE = lib
+
+
+SOURCES += altengine.cpp \
+    batchrouter.cpp \
+    bidirectionalengine.cpp \
+    contractionhierarchy.cpp \
+    deltasteppingengine.cpp \
+    densedijkstraengine.cpp \
+    dijkstraengine.cpp \
+    graphlayout.cpp \
+    jobprogress.cpp \
+    kshortestpaths.cpp \
+    networkfile.cpp \
+    networkmodel.cpp \
+    routinggraph.cpp \
+    routingtable.cpp \
+    sessionfile.cpp \
+    shortestpathtree.cpp \
+    specparser.cpp \
+    symboltable.cpp \
+    threadpool.cpp \
+    treecache.cpp
+
+HEADERS  += altengine.h \
+    batchrouter.h \
+    bidirectionalengine.h \
+    contractionhierarchy.h \
+    deltasteppingengine.h \
+    densedijkstraengine.h \
+    dijkstraengine.h \
+    graphlayout.h \
+    indexedheap.h \
+    jobprogress.h \
+    kshortestpaths.h \
+    networkfile.h \
+    networkmodel.h \
+    routinggraph.h \
+    routingtable.h \
+    searchspace.h \
+    sessionfile.h \
+    shortestpathtree.h \
+    specparser.h \
+    symboltable.h \
+    threadpool.h \
+    treecache.h
@@ -0,0 +1,229 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "altengine.h"
+#include "dijkstraengine.h"
+
+AltEngine::AltEngine(const RoutingGraph* graph /* = nullptr */)
+    : m_graph(nullptr)
+    , m_target(-1)
+    , m_settled(0)
+{
+    setGraph(graph);
+}
+
+void AltEngine::setGraph(const RoutingGraph* graph)
+{
+    int n = graph ? graph->vertexCount() : 0;
+
+    m_graph = graph;
+    m_landmarks.clear();
+    m_fromLandmark.clear();
+    m_toLandmark.clear();
+
+    m_distance.assign(n, Unreachable);
+    m_predecessor.assign(n, -1);
+    m_bound.assign(n, NotComputed);
+    m_touched.clear();
+    m_heap.resize(n);
+    m_target  = -1;
+    m_settled = 0;
+}
+
+bool AltEngine::preprocess(int landmarkCount,
+    JobProgress* progress /* = nullptr */)
+{
+    int n = m_graph ? m_graph->vertexCount() : 0;
+    int k = std::min(landmarkCount, n);
+
+    m_landmarks.clear();
+    m_fromLandmark.assign(static_cast<size_t>(n) * k, Unreachable);
+    m_toLandmark.assign(static_cast<size_t>(n) * k, Unreachable);
+    if (k <= 0) {
+        return true;
+    }
+    if (progress) {
+        progress->setTotal(k);
+    }
+
+    // Round-trip cost to the nearest landmark chosen so far; anything that
+    // no landmark can get to and back from counts as infinitely far away
+    std::vector<long long> nearest(n, LLONG_MAX);
+    DijkstraEngine         search(m_graph);
+
+    // Farthest-point selection, seeded with the node farthest from node 0
+    search.route(0);
+    for (int v = 0; v < n; ++v) {
+        nearest[v] = search.isReached(v) ? search.distance(v) : LLONG_MAX;
+    }
+
+    for (int i = 0; i < k; ++i) {
+        if (progress && progress->isCancelled()) {
+            m_landmarks.clear();
+            m_fromLandmark.clear();
+            m_toLandmark.clear();
+            return false;
+        }
+
+        int landmark = static_cast<int>(
+            std::max_element(nearest.begin(), nearest.end()) - nearest.begin());
+        if (i == 0) {
+            nearest.assign(n, LLONG_MAX);
+        }
+        m_landmarks.push_back(landmark);
+
+        // Costs from the landmark to everything...
+        search.route(landmark);
+        for (int v = 0; v < n; ++v) {
+            m_fromLandmark[static_cast<size_t>(v) * k + i] = search.distance(v);
+        }
+
+        // ...and from everything back to it
+        search.routeBackward(landmark);
+        for (int v = 0; v < n; ++v) {
+            m_toLandmark[static_cast<size_t>(v) * k + i] = search.distance(v);
+        }
+
+        for (int v = 0; v < n; ++v) {
+            Distance from = m_fromLandmark[static_cast<size_t>(v) * k + i];
+            Distance to   = m_toLandmark[static_cast<size_t>(v) * k + i];
+            if (from != Unreachable && to != Unreachable) {
+                nearest[v] = std::min(nearest[v],
+                    static_cast<long long>(from) + to);
+            }
+        }
+        if (progress) {
+            progress->advance();
+        }
+    }
+    return true;
+}
+
+bool AltEngine::route(int source, int target)
+{
+    reset();
+    m_target = target;
+
+    Distance bound = lowerBound(source);
+    if (bound == Unreachable) {
+        return false;
+    }
+
+    // Seed the search with the start node
+    m_distance[source] = 0;
+    m_heap.push(source, bound);
+
+    while (!m_heap.empty()) {
+        int      current = m_heap.pop();
+        Distance dist    = m_distance[current];
+
+        m_settled += 1;
+
+        // If we hit the target, we can stop
+        if (current == target) {
+            return true;
+        }
+
+        // Visit the neighbours, keyed on cost so far plus the lower bound
+        int last = m_graph->lastArc(current);
+        for (int a = m_graph->firstArc(current); a < last; ++a) {
+            int weight = m_graph->arcWeight(a);
+            if (weight > Unreachable - dist) {
+                continue;
+            }
+
+            int      neighbour = m_graph->arcTarget(a);
+            Distance newDist   = dist + weight;
+            if (newDist >= m_distance[neighbour]) {
+                continue;
+            }
+
+            Distance remaining = lowerBound(neighbour);
+            if (remaining == Unreachable ||
+                    remaining > Unreachable - newDist) {
+                continue;
+            }
+
+            m_distance[neighbour]    = newDist;
+            m_predecessor[neighbour] = m_graph->arcEdge(a);
+            m_heap.push(neighbour, newDist + remaining);
+        }
+    }
+
+    return false;
+}
+
+std::vector<int> AltEngine::path(int target) const
+{
+    std::vector<int> edges;
+
+    // Walk backwards from the target to the source, then flip it over
+    for (int e = m_predecessor[target]; e >= 0;
+            e = m_predecessor[m_graph->edge(e).source]) {
+        edges.push_back(e);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return edges;
+}
+
+Distance AltEngine::lowerBound(int v)
+{
+    if (m_bound[v] != NotComputed) {
+        return m_bound[v];
+    }
+
+    int       k     = landmarkCount();
+    size_t    row   = static_cast<size_t>(v) * k;
+    size_t    trow  = static_cast<size_t>(m_target) * k;
+    long long bound = 0;
+
+    for (int i = 0; i < k; ++i) {
+        Distance fromV = m_fromLandmark[row + i];
+        Distance fromT = m_fromLandmark[trow + i];
+        Distance toV   = m_toLandmark[row + i];
+        Distance toT   = m_toLandmark[trow + i];
+
+        // d(L, t) <= d(L, v) + d(v, t) and d(v, L) <= d(v, t) + d(t, L): if
+        // the landmark reaches v but not t, or t reaches it but v does not,
+        // then v cannot reach t at all
+        if ((fromV != Unreachable && fromT == Unreachable) ||
+                (toV == Unreachable && toT != Unreachable)) {
+            bound = Unreachable;
+            break;
+        }
+
+        if (fromV != Unreachable) {
+            bound = std::max(bound, static_cast<long long>(fromT) - fromV);
+        }
+        if (toT != Unreachable && toV != Unreachable) {
+            bound = std::max(bound, static_cast<long long>(toV) - toT);
+        }
+    }
+
+    // Every node the search looks at gets a bound first, so this is also
+    // where nodes are recorded for resetting
+    m_bound[v] = static_cast<Distance>(std::min<long long>(bound, Unreachable));
+    m_touched.push_back(v);
+
+    return m_bound[v];
+}
+
+void AltEngine::reset()
+{
+    // Only undo what the previous search actually wrote
+    for (size_t i = 0; i < m_touched.size(); ++i) {
+        m_distance[m_touched[i]]    = Unreachable;
+        m_predecessor[m_touched[i]] = -1;
+        m_bound[m_touched[i]]       = NotComputed;
+    }
+    m_touched.clear();
+    m_heap.clear();
+    m_settled = 0;
+}
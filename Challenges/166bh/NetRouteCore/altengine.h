@@ -0,0 +1,81 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef ALTENGINE_H
+#define ALTENGINE_H
+
+#include <vector>
+
+#include "indexedheap.h"
+#include "jobprogress.h"
+#include "routinggraph.h"
+
+
+// A* search with Landmarks and the Triangle inequality (ALT).
+//
+// Preprocessing picks landmarks by farthest-point selection and stores the
+// cost from every landmark to every node and from every node back to every
+// landmark.  Queries then run A* using the best lower bound these give on
+// the remaining cost to the target:
+//
+//     d(v, t) >= max(d(L, t) - d(L, v), d(v, L) - d(t, L))
+//
+// The bounds are consistent, so each node is still settled at most once.
+// They also prove some nodes cannot reach the target at all, and those are
+// skipped.
+class AltEngine
+{
+public:
+    AltEngine(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Counts the landmarks placed against progress; returns false, with no
+    // landmarks kept, if the job is cancelled part way through
+    bool preprocess(int landmarkCount, JobProgress* progress = nullptr);
+    bool isPreprocessed() const { return !m_landmarks.empty(); }
+
+    int landmarkCount() const { return static_cast<int>(m_landmarks.size()); }
+    const std::vector<int>& landmarks() const { return m_landmarks; }
+
+    // Returns whether target can be reached from source
+    bool route(int source, int target);
+
+    Distance distance(int v) const { return m_distance[v]; }
+
+    // Edge indices of the route found to target, ordered start to end
+    std::vector<int> path(int target) const;
+
+    int settledCount() const { return m_settled; }
+
+private:
+    Distance lowerBound(int v);
+    void     reset();
+
+private:
+    enum { NotComputed = -1 };
+
+    const RoutingGraph*     m_graph;
+
+    // Landmark distances, K consecutive entries per node
+    std::vector<int>        m_landmarks;
+    std::vector<Distance>   m_fromLandmark;
+    std::vector<Distance>   m_toLandmark;
+
+    // Per-query state
+    std::vector<Distance>   m_distance;
+    std::vector<int>        m_predecessor;
+    std::vector<Distance>   m_bound;
+    std::vector<int>        m_touched;
+    IndexedHeap             m_heap;
+    int                     m_target;
+    int                     m_settled;
+};
+
+
+#endif  /* !ALTENGINE_H */
@@ -0,0 +1,62 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include "batchrouter.h"
+
+BatchRouter::BatchRouter(const RoutingGraph* graph /* = nullptr */)
+    : m_graph(graph)
+{
+}
+
+void BatchRouter::setGraph(const RoutingGraph* graph)
+{
+    m_graph = graph;
+    m_engines.clear();
+    clear();
+}
+
+void BatchRouter::route(const std::vector<RouteQuery>& queries,
+                        ThreadPool* pool /* = nullptr */)
+{
+    m_queries = queries;
+    m_results.assign(queries.size(), RouteResult());
+    if (!m_graph) {
+        return;
+    }
+
+    // Search state is sized to the graph, so it is kept between batches
+    int threads = pool ? pool->threadCount() : 1;
+    if (static_cast<int>(m_engines.size()) != threads) {
+        m_engines.assign(threads, BidirectionalEngine(m_graph));
+    }
+
+    ThreadPool::Task task = [this](int index, int thread) {
+        BidirectionalEngine& engine = m_engines[thread];
+        const RouteQuery&    query  = m_queries[index];
+        RouteResult&         result = m_results[index];
+
+        if (engine.route(query.source, query.target)) {
+            result.distance = engine.distance();
+            result.path     = engine.path();
+        }
+        result.settled = engine.settledCount();
+    };
+
+    if (pool) {
+        pool->parallelFor(static_cast<int>(m_queries.size()), task);
+    } else {
+        for (size_t i = 0; i < m_queries.size(); ++i) {
+            task(static_cast<int>(i), 0);
+        }
+    }
+}
+
+void BatchRouter::clear()
+{
+    m_queries.clear();
+    m_results.clear();
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef BATCHROUTER_H
+#define BATCHROUTER_H
+
+#include <vector>
+
+#include "bidirectionalengine.h"
+#include "routinggraph.h"
+#include "threadpool.h"
+
+
+// One start/end pair of a batch
+struct RouteQuery
+{
+    int         source;
+    int         target;
+
+    RouteQuery(int source_ = -1, int target_ = -1)
+        : source(source_)
+        , target(target_)
+    {
+    }
+};
+
+// Outcome of one query; distance is Unreachable if there is no route
+struct RouteResult
+{
+    Distance            distance;
+    int                 settled;
+    std::vector<int>    path;
+
+    RouteResult() : distance(Unreachable), settled(0) {}
+};
+
+
+// Answers a list of start/end queries across a thread pool.  Every thread
+// gets its own BidirectionalEngine, so the only state the threads share is
+// the read-only graph and their own slots of the result table.
+class BatchRouter
+{
+public:
+    BatchRouter(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Solves every query, on the calling thread alone if pool is null
+    void route(const std::vector<RouteQuery>& queries,
+        ThreadPool* pool = nullptr);
+    void clear();
+
+    bool isEmpty() const { return m_results.empty(); }
+    int  queryCount() const { return static_cast<int>(m_queries.size()); }
+
+    const RouteQuery&  query(int i) const { return m_queries[i]; }
+    const RouteResult& result(int i) const { return m_results[i]; }
+
+private:
+    const RoutingGraph*                 m_graph;
+    std::vector<BidirectionalEngine>    m_engines;
+
+    std::vector<RouteQuery>             m_queries;
+    std::vector<RouteResult>            m_results;
+};
+
+
+#endif  /* !BATCHROUTER_H */
@@ -0,0 +1,146 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "bidirectionalengine.h"
+
+BidirectionalEngine::BidirectionalEngine(
+    const RoutingGraph* graph /* = nullptr */)
+    : m_graph(nullptr)
+    , m_best(Unreachable)
+    , m_meeting(-1)
+{
+    setGraph(graph);
+}
+
+void BidirectionalEngine::setGraph(const RoutingGraph* graph)
+{
+    int n = graph ? graph->vertexCount() : 0;
+
+    m_graph = graph;
+    m_forward.resize(n);
+    m_backward.resize(n);
+    m_best    = Unreachable;
+    m_meeting = -1;
+}
+
+bool BidirectionalEngine::route(int source, int target)
+{
+    m_forward.reset();
+    m_backward.reset();
+    m_best    = Unreachable;
+    m_meeting = -1;
+
+    m_forward.seed(source);
+    m_backward.seed(target);
+    if (source == target) {
+        m_best    = 0;
+        m_meeting = source;
+        return true;
+    }
+
+    while (!m_forward.heap.empty() && !m_backward.heap.empty()) {
+        // Nothing left in either queue can improve on the best meeting point
+        long long bound = static_cast<long long>(m_forward.heap.topKey()) +
+            m_backward.heap.topKey();
+        if (bound >= m_best) {
+            break;
+        }
+
+        if (m_forward.heap.size() <= m_backward.heap.size()) {
+            stepForward();
+        } else {
+            stepBackward();
+        }
+    }
+
+    return m_best != Unreachable;
+}
+
+std::vector<int> BidirectionalEngine::path() const
+{
+    std::vector<int> edges;
+    if (m_meeting < 0) {
+        return edges;
+    }
+
+    // Start to meeting point, from the forward predecessors
+    for (int e = m_forward.edge[m_meeting]; e >= 0;
+            e = m_forward.edge[m_graph->edge(e).source]) {
+        edges.push_back(e);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    // Meeting point to end, from the backward successors
+    for (int e = m_backward.edge[m_meeting]; e >= 0;
+            e = m_backward.edge[m_graph->edge(e).target]) {
+        edges.push_back(e);
+    }
+
+    return edges;
+}
+
+void BidirectionalEngine::stepForward()
+{
+    int      current = m_forward.heap.pop();
+    Distance dist    = m_forward.distance[current];
+
+    m_forward.settled += 1;
+
+    int last = m_graph->lastArc(current);
+    for (int a = m_graph->firstArc(current); a < last; ++a) {
+        int weight = m_graph->arcWeight(a);
+        if (weight > Unreachable - dist) {
+            continue;
+        }
+
+        int      neighbour = m_graph->arcTarget(a);
+        Distance newDist   = dist + weight;
+        if (!m_forward.relax(neighbour, newDist, m_graph->arcEdge(a))) {
+            continue;
+        }
+
+        // Does this close a shorter route through the other search?
+        Distance other = m_backward.distance[neighbour];
+        if (other != Unreachable &&
+                static_cast<long long>(newDist) + other < m_best) {
+            m_best    = newDist + other;
+            m_meeting = neighbour;
+        }
+    }
+}
+
+void BidirectionalEngine::stepBackward()
+{
+    int      current = m_backward.heap.pop();
+    Distance dist    = m_backward.distance[current];
+
+    m_backward.settled += 1;
+
+    int last = m_graph->lastInArc(current);
+    for (int a = m_graph->firstInArc(current); a < last; ++a) {
+        int weight = m_graph->inArcWeight(a);
+        if (weight > Unreachable - dist) {
+            continue;
+        }
+
+        int      neighbour = m_graph->inArcSource(a);
+        Distance newDist   = dist + weight;
+        if (!m_backward.relax(neighbour, newDist, m_graph->inArcEdge(a))) {
+            continue;
+        }
+
+        // Does this close a shorter route through the other search?
+        Distance other = m_forward.distance[neighbour];
+        if (other != Unreachable &&
+                static_cast<long long>(newDist) + other < m_best) {
+            m_best    = newDist + other;
+            m_meeting = neighbour;
+        }
+    }
+}
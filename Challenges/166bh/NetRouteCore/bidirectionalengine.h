@@ -0,0 +1,58 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef BIDIRECTIONALENGINE_H
+#define BIDIRECTIONALENGINE_H
+
+#include <vector>
+
+#include "routinggraph.h"
+#include "searchspace.h"
+
+
+// Bidirectional Dijkstra for single start/end queries.  One search runs
+// forwards over the outgoing arcs of the start node and the other backwards
+// over the incoming arcs of the end node, always expanding whichever frontier
+// is smaller.  The searches stop once the sum of their smallest queued keys
+// can no longer beat the best meeting point found so far.
+class BidirectionalEngine
+{
+public:
+    BidirectionalEngine(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Returns whether target can be reached from source
+    bool route(int source, int target);
+
+    // Cost of the route found by the last query, or Unreachable
+    Distance distance() const { return m_best; }
+
+    // Edge indices of the route found, ordered start to end
+    std::vector<int> path() const;
+
+    int settledCount() const
+        { return m_forward.settled + m_backward.settled; }
+    int forwardSettledCount() const { return m_forward.settled; }
+    int backwardSettledCount() const { return m_backward.settled; }
+
+private:
+    void stepForward();
+    void stepBackward();
+
+private:
+    const RoutingGraph*     m_graph;
+
+    SearchSpace             m_forward;
+    SearchSpace             m_backward;
+    Distance                m_best;
+    int                     m_meeting;
+};
+
+
+#endif  /* !BIDIRECTIONALENGINE_H */
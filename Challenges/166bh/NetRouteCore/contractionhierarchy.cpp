@@ -0,0 +1,443 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "contractionhierarchy.h"
+
+// Witness searches give up after settling this many nodes.  Giving up early
+// only ever adds shortcuts that were not strictly needed, so the searches
+// that merely estimate a node's priority are kept much shorter.
+static const int WitnessSettleLimit  = 500;
+static const int PrioritySettleLimit = 50;
+
+ContractionHierarchy::ContractionHierarchy()
+    : m_vertexCount(0)
+    , m_shortcutCount(0)
+    , m_best(Unreachable)
+    , m_meeting(-1)
+{
+}
+
+bool ContractionHierarchy::build(const RoutingGraph& graph,
+    JobProgress* progress /* = nullptr */)
+{
+    clear();
+
+    int n = graph.vertexCount();
+    m_vertexCount = n;
+    if (progress) {
+        progress->setTotal(n);
+    }
+
+    // Start from the original edges; self loops never help a route
+    m_out.assign(n, ArcList());
+    m_in.assign(n, ArcList());
+    for (int e = 0; e < graph.edgeCount(); ++e) {
+        const RoutingEdge& edge = graph.edge(e);
+        if (!graph.hasEdge(e) || edge.source == edge.target) {
+            continue;
+        }
+
+        Edge hierarchyEdge = { edge.source, edge.target, e, -1, -1 };
+        m_edges.push_back(hierarchyEdge);
+        addArc(edge.source, edge.target, edge.weight,
+            static_cast<int>(m_edges.size()) - 1);
+    }
+
+    m_contractedNeighbours.assign(n, 0);
+    m_witness.assign(n, Unreachable);
+    m_witnessTarget.assign(n, false);
+    m_witnessTouched.clear();
+    m_witnessHeap.resize(n);
+
+    // Contract the cheapest node each time.  Priorities go stale as the
+    // graph changes, so the top one is re-evaluated before it is used.
+    IndexedHeap queue;
+    queue.resize(n);
+    for (int v = 0; v < n; ++v) {
+        queue.push(v, priority(v));
+    }
+
+    std::vector<int> rank(n, 0);
+    for (int order = 0; !queue.empty(); ++order) {
+        if (progress && progress->isCancelled()) {
+            releaseContractionState();
+            clear();
+            return false;
+        }
+
+        int v = queue.pop();
+
+        int current = priority(v);
+        if (!queue.empty() && current > queue.topKey()) {
+            queue.push(v, current);
+            --order;
+            continue;
+        }
+
+        contract(v, false);
+        rank[v] = order;
+        if (progress) {
+            progress->advance();
+        }
+
+        // Every arc still attached to v leads to a node contracted later, so
+        // v keeps them as its part of the hierarchy and its neighbours drop
+        // them.  The neighbours also gain a contracted neighbour.
+        for (size_t i = 0; i < m_out[v].size(); ++i) {
+            int x = m_out[v][i].other;
+            detachArc(m_in[x], v);
+            m_contractedNeighbours[x] += 1;
+        }
+        for (size_t i = 0; i < m_in[v].size(); ++i) {
+            int u = m_in[v][i].other;
+            detachArc(m_out[u], v);
+            m_contractedNeighbours[u] += 1;
+        }
+
+        for (size_t i = 0; i < m_out[v].size(); ++i) {
+            queue.update(m_out[v][i].other, priority(m_out[v][i].other));
+        }
+        for (size_t i = 0; i < m_in[v].size(); ++i) {
+            queue.update(m_in[v][i].other, priority(m_in[v][i].other));
+        }
+    }
+
+    // Pack what each node kept into the upward and downward graphs
+    m_upOffsets.assign(n + 1, 0);
+    m_downOffsets.assign(n + 1, 0);
+    for (int v = 0; v < n; ++v) {
+        m_upOffsets[v + 1]   = m_upOffsets[v] + static_cast<int>(m_out[v].size());
+        m_downOffsets[v + 1] = m_downOffsets[v] + static_cast<int>(m_in[v].size());
+    }
+
+    m_upTargets.resize(m_upOffsets[n]);
+    m_upWeights.resize(m_upOffsets[n]);
+    m_upEdges.resize(m_upOffsets[n]);
+    m_downSources.resize(m_downOffsets[n]);
+    m_downWeights.resize(m_downOffsets[n]);
+    m_downEdges.resize(m_downOffsets[n]);
+
+    for (int v = 0; v < n; ++v) {
+        for (size_t i = 0; i < m_out[v].size(); ++i) {
+            int slot = m_upOffsets[v] + static_cast<int>(i);
+            m_upTargets[slot] = m_out[v][i].other;
+            m_upWeights[slot] = m_out[v][i].weight;
+            m_upEdges[slot]   = m_out[v][i].edge;
+        }
+        for (size_t i = 0; i < m_in[v].size(); ++i) {
+            int slot = m_downOffsets[v] + static_cast<int>(i);
+            m_downSources[slot] = m_in[v][i].other;
+            m_downWeights[slot] = m_in[v][i].weight;
+            m_downEdges[slot]   = m_in[v][i].edge;
+        }
+    }
+
+    m_rank.swap(rank);
+    m_forward.resize(n);
+    m_backward.resize(n);
+
+    releaseContractionState();
+    return true;
+}
+
+void ContractionHierarchy::releaseContractionState()
+{
+    // The contraction state is not needed for queries
+    std::vector<ArcList>().swap(m_out);
+    std::vector<ArcList>().swap(m_in);
+    std::vector<int>().swap(m_contractedNeighbours);
+    std::vector<Distance>().swap(m_witness);
+    std::vector<bool>().swap(m_witnessTarget);
+    std::vector<int>().swap(m_witnessTouched);
+    m_witnessHeap.resize(0);
+}
+
+void ContractionHierarchy::clear()
+{
+    m_vertexCount   = 0;
+    m_shortcutCount = 0;
+    m_rank.clear();
+    m_edges.clear();
+
+    m_upOffsets.clear();
+    m_upTargets.clear();
+    m_upWeights.clear();
+    m_upEdges.clear();
+    m_downOffsets.clear();
+    m_downSources.clear();
+    m_downWeights.clear();
+    m_downEdges.clear();
+
+    m_forward.resize(0);
+    m_backward.resize(0);
+    m_best    = Unreachable;
+    m_meeting = -1;
+}
+
+bool ContractionHierarchy::route(int source, int target)
+{
+    m_forward.reset();
+    m_backward.reset();
+    m_best    = Unreachable;
+    m_meeting = -1;
+
+    m_forward.seed(source);
+    m_backward.seed(target);
+
+    // Both searches only climb, so neither can stop at the first meeting
+    // point; each runs until its queue cannot beat the best route found
+    for (;;) {
+        bool forward = !m_forward.heap.empty() &&
+            m_forward.heap.topKey() < m_best;
+        bool backward = !m_backward.heap.empty() &&
+            m_backward.heap.topKey() < m_best;
+        if (!forward && !backward) {
+            break;
+        }
+
+        if (forward) {
+            step(m_forward, m_backward,
+                m_upOffsets, m_upTargets, m_upWeights, m_upEdges);
+        }
+        if (backward) {
+            step(m_backward, m_forward,
+                m_downOffsets, m_downSources, m_downWeights, m_downEdges);
+        }
+    }
+
+    return m_best != Unreachable;
+}
+
+std::vector<int> ContractionHierarchy::path() const
+{
+    std::vector<int> edges;
+    if (m_meeting < 0) {
+        return edges;
+    }
+
+    // Hierarchy edges from the start up to the meeting point...
+    std::vector<int> route;
+    for (int e = m_forward.edge[m_meeting]; e >= 0;
+            e = m_forward.edge[m_edges[e].source]) {
+        route.push_back(e);
+    }
+    std::reverse(route.begin(), route.end());
+
+    // ...and from there down to the end
+    for (int e = m_backward.edge[m_meeting]; e >= 0;
+            e = m_backward.edge[m_edges[e].target]) {
+        route.push_back(e);
+    }
+
+    // Unpack the shortcuts, keeping the edges in order with a stack
+    std::vector<int> pending(route.rbegin(), route.rend());
+    while (!pending.empty()) {
+        const Edge& edge = m_edges[pending.back()];
+        pending.pop_back();
+
+        if (edge.original >= 0) {
+            edges.push_back(edge.original);
+        } else {
+            pending.push_back(edge.second);
+            pending.push_back(edge.first);
+        }
+    }
+
+    return edges;
+}
+
+void ContractionHierarchy::addArc(int source, int target, Distance weight,
+                                  int edge)
+{
+    // Only the cheapest of any parallel arcs is worth keeping
+    ArcList& out = m_out[source];
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (out[i].other != target) {
+            continue;
+        }
+        if (weight < out[i].weight) {
+            out[i].weight = weight;
+            out[i].edge   = edge;
+
+            ArcList& in = m_in[target];
+            for (size_t j = 0; j < in.size(); ++j) {
+                if (in[j].other == source) {
+                    in[j].weight = weight;
+                    in[j].edge   = edge;
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    Arc forward  = { target, weight, edge };
+    Arc backward = { source, weight, edge };
+    out.push_back(forward);
+    m_in[target].push_back(backward);
+}
+
+void ContractionHierarchy::detachArc(ArcList& arcs, int other)
+{
+    for (size_t i = 0; i < arcs.size(); ++i) {
+        if (arcs[i].other == other) {
+            arcs[i] = arcs.back();
+            arcs.pop_back();
+            return;
+        }
+    }
+}
+
+int ContractionHierarchy::contract(int v, bool simulate)
+{
+    int shortcuts = 0;
+
+    const ArcList& in  = m_in[v];
+    const ArcList& out = m_out[v];
+
+    // Witness searches can stop once they have settled all of these
+    for (size_t j = 0; j < out.size(); ++j) {
+        m_witnessTarget[out[j].other] = true;
+    }
+
+    for (size_t i = 0; i < in.size(); ++i) {
+        int u = in[i].other;
+
+        // The witness search need not look further than the longest route
+        // through v
+        long long limit = -1;
+        for (size_t j = 0; j < out.size(); ++j) {
+            if (out[j].other != u) {
+                limit = std::max(limit,
+                    static_cast<long long>(in[i].weight) + out[j].weight);
+            }
+        }
+        if (limit < 0) {
+            continue;
+        }
+
+        findWitnesses(u, v,
+            static_cast<Distance>(std::min<long long>(limit, Unreachable)),
+            static_cast<int>(out.size()),
+            simulate ? PrioritySettleLimit : WitnessSettleLimit);
+
+        for (size_t j = 0; j < out.size(); ++j) {
+            int x = out[j].other;
+            if (x == u) {
+                continue;
+            }
+
+            long long via = static_cast<long long>(in[i].weight) +
+                out[j].weight;
+            if (via >= Unreachable || m_witness[x] <= via) {
+                continue;
+            }
+
+            shortcuts += 1;
+            if (!simulate) {
+                Edge shortcut = { u, x, -1, in[i].edge, out[j].edge };
+                m_edges.push_back(shortcut);
+                addArc(u, x, static_cast<Distance>(via),
+                    static_cast<int>(m_edges.size()) - 1);
+                m_shortcutCount += 1;
+            }
+        }
+    }
+
+    for (size_t j = 0; j < out.size(); ++j) {
+        m_witnessTarget[out[j].other] = false;
+    }
+
+    return shortcuts;
+}
+
+int ContractionHierarchy::priority(int v)
+{
+    int removed = static_cast<int>(m_in[v].size() + m_out[v].size());
+
+    // Edge difference, plus a term that spreads contraction evenly
+    return contract(v, true) - removed + m_contractedNeighbours[v];
+}
+
+void ContractionHierarchy::findWitnesses(int source, int skip,
+                                         Distance limit, int targets,
+                                         int settleLimit)
+{
+    for (size_t i = 0; i < m_witnessTouched.size(); ++i) {
+        m_witness[m_witnessTouched[i]] = Unreachable;
+    }
+    m_witnessTouched.clear();
+    m_witnessHeap.clear();
+
+    m_witness[source] = 0;
+    m_witnessTouched.push_back(source);
+    m_witnessHeap.push(source, 0);
+
+    // Plain Dijkstra over what is left of the graph, without the node that
+    // is being contracted
+    for (int settled = 0; !m_witnessHeap.empty() &&
+            settled < settleLimit; ++settled) {
+        if (m_witnessHeap.topKey() > limit) {
+            break;
+        }
+
+        int      current = m_witnessHeap.pop();
+        Distance dist    = m_witness[current];
+
+        if (m_witnessTarget[current] && --targets == 0) {
+            break;
+        }
+
+        const ArcList& out = m_out[current];
+        for (size_t i = 0; i < out.size(); ++i) {
+            int neighbour = out[i].other;
+            if (neighbour == skip || out[i].weight > Unreachable - dist) {
+                continue;
+            }
+
+            Distance newDist = dist + out[i].weight;
+            if (newDist >= m_witness[neighbour]) {
+                continue;
+            }
+
+            if (m_witness[neighbour] == Unreachable) {
+                m_witnessTouched.push_back(neighbour);
+            }
+            m_witness[neighbour] = newDist;
+            m_witnessHeap.push(neighbour, newDist);
+        }
+    }
+}
+
+void ContractionHierarchy::step(SearchSpace& self, const SearchSpace& other,
+                                const std::vector<int>& offsets,
+                                const std::vector<int>& heads,
+                                const std::vector<int>& weights,
+                                const std::vector<int>& edges)
+{
+    int      current = self.heap.pop();
+    Distance dist    = self.distance[current];
+
+    self.settled += 1;
+
+    // Any node both searches reach is a candidate meeting point
+    Distance remaining = other.distance[current];
+    if (remaining != Unreachable &&
+            static_cast<long long>(dist) + remaining < m_best) {
+        m_best    = dist + remaining;
+        m_meeting = current;
+    }
+
+    for (int a = offsets[current]; a < offsets[current + 1]; ++a) {
+        if (weights[a] > Unreachable - dist) {
+            continue;
+        }
+        self.relax(heads[a], dist + weights[a], edges[a]);
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <vector>
+
+#include "indexedheap.h"
+#include "jobprogress.h"
+#include "routinggraph.h"
+#include "searchspace.h"
+
+
+// Contraction hierarchies for a network that stays loaded and answers many
+// queries.
+//
+// Preprocessing contracts the nodes one at a time, cheapest first.  The cost
+// of a node is its edge difference (the shortcuts it needs minus the arcs it
+// removes) plus the number of its neighbours already contracted, and it is
+// re-evaluated lazily.  A shortcut u->x is added for a node v only when a
+// bounded witness search from u cannot find a path to x that avoids v and
+// is no longer than u->v->x.  A query is then a bidirectional Dijkstra that
+// only ever moves up the hierarchy.  Each shortcut remembers the two arcs it
+// replaces, so routes unpack back into the original edges.
+class ContractionHierarchy
+{
+public:
+    ContractionHierarchy();
+
+    // Counts the nodes contracted against progress; returns false, with
+    // the hierarchy cleared, if the job is cancelled part way through
+    bool build(const RoutingGraph& graph, JobProgress* progress = nullptr);
+    void clear();
+
+    bool isBuilt() const { return !m_rank.empty(); }
+    int  shortcutCount() const { return m_shortcutCount; }
+
+    // Returns whether target can be reached from source
+    bool route(int source, int target);
+
+    // Cost of the route found by the last query, or Unreachable
+    Distance distance() const { return m_best; }
+
+    // Original edge indices of the route found, ordered start to end
+    std::vector<int> path() const;
+
+    int settledCount() const
+        { return m_forward.settled + m_backward.settled; }
+
+private:
+    // An original edge, or a shortcut made of two other hierarchy edges
+    struct Edge
+    {
+        int         source;
+        int         target;
+        int         original;
+        int         first;
+        int         second;
+    };
+
+    // Adjacency entry used while contracting
+    struct Arc
+    {
+        int         other;
+        Distance    weight;
+        int         edge;
+    };
+    typedef std::vector<Arc> ArcList;
+
+    void addArc(int source, int target, Distance weight, int edge);
+    void detachArc(ArcList& arcs, int other);
+    int  contract(int v, bool simulate);
+    int  priority(int v);
+    void releaseContractionState();
+    void findWitnesses(int source, int skip, Distance limit, int targets,
+        int settleLimit);
+
+    void step(SearchSpace& self, const SearchSpace& other,
+        const std::vector<int>& offsets, const std::vector<int>& heads,
+        const std::vector<int>& weights, const std::vector<int>& edges);
+
+private:
+    int                     m_vertexCount;
+    int                     m_shortcutCount;
+    std::vector<int>        m_rank;
+    std::vector<Edge>       m_edges;
+
+    // Arcs leading up the hierarchy out of each node, for forward searches
+    std::vector<int>        m_upOffsets;
+    std::vector<int>        m_upTargets;
+    std::vector<int>        m_upWeights;
+    std::vector<int>        m_upEdges;
+
+    // Arcs leading up the hierarchy into each node, for backward searches
+    std::vector<int>        m_downOffsets;
+    std::vector<int>        m_downSources;
+    std::vector<int>        m_downWeights;
+    std::vector<int>        m_downEdges;
+
+    // Arcs to the nodes not yet contracted, only held during build()
+    std::vector<ArcList>    m_out;
+    std::vector<ArcList>    m_in;
+    std::vector<int>        m_contractedNeighbours;
+    std::vector<Distance>   m_witness;
+    std::vector<bool>       m_witnessTarget;
+    std::vector<int>        m_witnessTouched;
+    IndexedHeap             m_witnessHeap;
+
+    // Query state
+    SearchSpace             m_forward;
+    SearchSpace             m_backward;
+    Distance                m_best;
+    int                     m_meeting;
+};
+
+
+#endif  /* !CONTRACTIONHIERARCHY_H */
@@ -0,0 +1,346 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "deltasteppingengine.h"
+#include "threadpool.h"
+
+// Nodes handed to a thread at a time
+static const int ChunkSize = 256;
+
+// Lowers slot to value if that is an improvement; true if it was, with the
+// value it replaced left in current
+static bool lowerTo(std::atomic<Distance>& slot, Distance value,
+    Distance& current)
+{
+    current = slot.load(std::memory_order_relaxed);
+    while (value < current) {
+        if (slot.compare_exchange_weak(current, value,
+                std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+DeltaSteppingEngine::DeltaSteppingEngine(
+    const RoutingGraph* graph /* = nullptr */)
+    : m_graph(nullptr)
+    , m_delta(0)
+    , m_usedDelta(0)
+    , m_maxWeight(-1)
+    , m_autoDelta(1)
+    , m_settled(0)
+    , m_buckets(0)
+{
+    setGraph(graph);
+}
+
+void DeltaSteppingEngine::setGraph(const RoutingGraph* graph)
+{
+    int n = graph ? graph->vertexCount() : 0;
+
+    m_graph = graph;
+    std::vector<std::atomic<Distance> >(n).swap(m_distance);
+    for (int v = 0; v < n; ++v) {
+        m_distance[v].store(Unreachable, std::memory_order_relaxed);
+    }
+    m_predecessor.assign(n, -1);
+    m_inFrontier.assign(n, false);
+    m_inBucket.assign(n, false);
+    m_reached.clear();
+    m_bucket.clear();
+    m_improved.clear();
+    m_newlyReached.clear();
+    m_maxWeight = -1;
+    m_settled   = 0;
+    m_buckets   = 0;
+}
+
+bool DeltaSteppingEngine::route(int source, int target /* = -1 */,
+                                ThreadPool* pool /* = nullptr */)
+{
+    // Only what the last search reached needs to be forgotten
+    for (size_t i = 0; i < m_reached.size(); ++i) {
+        m_distance[m_reached[i]].store(Unreachable,
+            std::memory_order_relaxed);
+        m_predecessor[m_reached[i]] = -1;
+    }
+    m_reached.clear();
+    m_settled = 0;
+    m_buckets = 0;
+
+    if (m_maxWeight < 0) {
+        measureWeights();
+    }
+    m_usedDelta = m_delta > 0 ? m_delta : m_autoDelta;
+
+    // Live entries never span more than maxWeight / delta + 1 buckets.  The
+    // buckets are left empty by every search, so they are only resized.
+    int    delta   = m_usedDelta;
+    int    threads = pool ? pool->threadCount() : 1;
+    size_t buckets = m_maxWeight / delta + 2;
+    if (m_bucket.size() != buckets) {
+        std::vector<std::vector<int> >(buckets).swap(m_bucket);
+    }
+    m_improved.resize(threads);
+    m_newlyReached.resize(threads);
+
+    m_distance[source].store(0, std::memory_order_relaxed);
+    m_reached.push_back(source);
+    m_bucket[0].push_back(source);
+
+    std::vector<int> frontier;
+    std::vector<int> settled;
+    size_t           pending = 1;
+
+    for (long long current = 0; pending > 0; ++current) {
+        std::vector<int>& bucket = m_bucket[current % m_bucket.size()];
+        if (bucket.empty()) {
+            continue;
+        }
+        m_buckets += 1;
+
+        // Light arcs can put nodes back into this bucket, so keep going
+        // until it stays empty
+        while (!bucket.empty()) {
+            frontier.clear();
+            for (size_t i = 0; i < bucket.size(); ++i) {
+                int v = bucket[i];
+                if (distance(v) / delta == current && !m_inFrontier[v]) {
+                    m_inFrontier[v] = true;
+                    frontier.push_back(v);
+
+                    if (!m_inBucket[v]) {
+                        m_inBucket[v] = true;
+                        settled.push_back(v);
+                    }
+                }
+            }
+            pending -= bucket.size();
+            bucket.clear();
+
+            relax(frontier, true, pool);
+            for (size_t i = 0; i < frontier.size(); ++i) {
+                m_inFrontier[frontier[i]] = false;
+            }
+            pending += collect();
+        }
+
+        // Heavy arcs only ever reach later buckets
+        relax(settled, false, pool);
+        pending += collect();
+
+        m_settled += static_cast<int>(settled.size());
+        for (size_t i = 0; i < settled.size(); ++i) {
+            m_inBucket[settled[i]] = false;
+        }
+        settled.clear();
+
+        // Everything up to this bucket is final
+        if (target >= 0 && isReached(target) &&
+                distance(target) / delta <= current) {
+            break;
+        }
+    }
+
+    // Leave nothing behind for the next search
+    for (size_t i = 0; i < m_bucket.size(); ++i) {
+        m_bucket[i].clear();
+    }
+
+    buildPredecessors(source, pool);
+    return target >= 0 ? isReached(target) : true;
+}
+
+void DeltaSteppingEngine::measureWeights()
+{
+    int       n    = m_graph->vertexCount();
+    long long arcs = 0;
+
+    m_maxWeight = 0;
+    for (int v = 0; v < n; ++v) {
+        int last = m_graph->lastArc(v);
+        for (int a = m_graph->firstArc(v); a < last; ++a) {
+            m_maxWeight = std::max(m_maxWeight, m_graph->arcWeight(a));
+        }
+        arcs += last - m_graph->firstArc(v);
+    }
+
+    // Without a width from the user, aim for roughly one heavy arc per node
+    long long degree = std::max<long long>(1, arcs / std::max(n, 1));
+    m_autoDelta = std::max(1, static_cast<int>(m_maxWeight / degree));
+}
+
+std::vector<int> DeltaSteppingEngine::path(int target) const
+{
+    std::vector<int> edges;
+
+    // Walk backwards from the target to the source, then flip it over
+    for (int e = m_predecessor[target]; e >= 0;
+            e = m_predecessor[m_graph->edge(e).source]) {
+        edges.push_back(e);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return edges;
+}
+
+void DeltaSteppingEngine::relax(const std::vector<int>& nodes, bool light,
+                                ThreadPool* pool)
+{
+    int delta = m_usedDelta;
+
+    forEachChunk(static_cast<int>(nodes.size()), pool,
+        [this, &nodes, light, delta](int begin, int end, int thread) {
+            std::vector<int>& improved     = m_improved[thread];
+            std::vector<int>& newlyReached = m_newlyReached[thread];
+
+            for (int i = begin; i < end; ++i) {
+                int      v    = nodes[i];
+                Distance dist = distance(v);
+
+                int last = m_graph->lastArc(v);
+                for (int a = m_graph->firstArc(v); a < last; ++a) {
+                    int weight = m_graph->arcWeight(a);
+                    if ((weight <= delta) != light ||
+                            weight > Unreachable - dist) {
+                        continue;
+                    }
+
+                    // Only one thread can be the first to reach w
+                    int      w = m_graph->arcTarget(a);
+                    Distance old;
+                    if (lowerTo(m_distance[w], dist + weight, old)) {
+                        improved.push_back(w);
+                        if (old == Unreachable) {
+                            newlyReached.push_back(w);
+                        }
+                    }
+                }
+            }
+        });
+}
+
+int DeltaSteppingEngine::collect()
+{
+    int delta = m_usedDelta;
+    int count = 0;
+
+    // Stale entries are skipped when their bucket comes round
+    for (size_t t = 0; t < m_improved.size(); ++t) {
+        std::vector<int>& improved = m_improved[t];
+        for (size_t i = 0; i < improved.size(); ++i) {
+            long long bucket = distance(improved[i]) / delta;
+            m_bucket[bucket % m_bucket.size()].push_back(improved[i]);
+        }
+        count += static_cast<int>(improved.size());
+        improved.clear();
+
+        std::vector<int>& newlyReached = m_newlyReached[t];
+        m_reached.insert(m_reached.end(), newlyReached.begin(),
+            newlyReached.end());
+        newlyReached.clear();
+    }
+
+    return count;
+}
+
+void DeltaSteppingEngine::buildPredecessors(int source, ThreadPool* pool)
+{
+    std::atomic<bool> zeroTies(false);
+
+    // Take the lowest-numbered tight arc into every node reached.  Chains of
+    // those strictly lose distance, so they cannot loop.
+    forEachChunk(static_cast<int>(m_reached.size()), pool,
+        [this, source, &zeroTies](int begin, int end, int) {
+            for (int i = begin; i < end; ++i) {
+                int      v    = m_reached[i];
+                Distance dist = distance(v);
+                if (v == source) {
+                    continue;
+                }
+
+                int  best = -1;
+                bool zero = false;
+                int  last = m_graph->lastInArc(v);
+                for (int a = m_graph->firstInArc(v); a < last; ++a) {
+                    Distance from = distance(m_graph->inArcSource(a));
+                    if (from == Unreachable ||
+                            static_cast<long long>(from) +
+                                m_graph->inArcWeight(a) != dist) {
+                        continue;
+                    }
+
+                    if (m_graph->inArcWeight(a) == 0) {
+                        zero = true;
+                    } else if (best < 0 || m_graph->inArcEdge(a) < best) {
+                        best = m_graph->inArcEdge(a);
+                    }
+                }
+
+                m_predecessor[v] = best;
+                if (best < 0 && zero) {
+                    zeroTies = true;
+                }
+            }
+        });
+
+    if (!zeroTies) {
+        return;
+    }
+
+    // Nodes only reached through zero-weight arcs could point at each other,
+    // so they hang off a breadth-first tree of tight arcs instead.  The
+    // bucket flags are all clear between searches, so they mark the visits.
+    std::vector<bool>& visited = m_inBucket;
+    std::vector<int>   queue(1, source);
+    visited[source] = true;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        int      v    = queue[i];
+        Distance dist = distance(v);
+
+        int last = m_graph->lastArc(v);
+        for (int a = m_graph->firstArc(v); a < last; ++a) {
+            int w = m_graph->arcTarget(a);
+            if (visited[w] || static_cast<long long>(dist) +
+                    m_graph->arcWeight(a) != distance(w)) {
+                continue;
+            }
+
+            visited[w] = true;
+            queue.push_back(w);
+            if (m_predecessor[w] < 0) {
+                m_predecessor[w] = m_graph->arcEdge(a);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < queue.size(); ++i) {
+        visited[queue[i]] = false;
+    }
+}
+
+void DeltaSteppingEngine::forEachChunk(int count, ThreadPool* pool,
+    const std::function<void (int, int, int)>& task)
+{
+    int chunks = (count + ChunkSize - 1) / ChunkSize;
+
+    ThreadPool::Task chunkTask = [count, &task](int chunk, int thread) {
+        int begin = chunk * ChunkSize;
+        task(begin, std::min(begin + ChunkSize, count), thread);
+    };
+
+    if (pool) {
+        pool->parallelFor(chunks, chunkTask);
+    } else {
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            chunkTask(chunk, 0);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef DELTASTEPPINGENGINE_H
+#define DELTASTEPPINGENGINE_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "routinggraph.h"
+
+class ThreadPool;
+
+
+// Delta-stepping shortest paths (Meyer and Sanders) spread over a thread
+// pool.
+//
+// Tentative distances are kept in buckets of width delta, and a whole bucket
+// is settled at once.  Its light arcs (no heavier than delta) are relaxed
+// again and again until the bucket stops changing.  Its heavy arcs are then
+// relaxed once, because they can only reach later buckets.  Each thread
+// records the nodes it improved in its own buffer, and distances are lowered
+// with compare-and-swap.  The buffers are merged into the buckets between
+// rounds.
+//
+// Distances match DijkstraEngine.  Predecessors are chosen afterwards from
+// the tight arcs, taking the lowest edge index, so they agree with it
+// whenever the shortest path is unique.
+//
+// Only the nodes a search reaches are reset for the next one, and the
+// heaviest weight and the average degree are worked out once per graph, so
+// a search that stops early costs no more than the part it explored.
+class DeltaSteppingEngine
+{
+public:
+    DeltaSteppingEngine(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Bucket width; zero picks one from the weights and degrees of the graph
+    int  delta() const { return m_delta; }
+    void setDelta(int delta) { m_delta = delta < 0 ? 0 : delta; }
+
+    // The graph's weights were edited in place, so the automatic width and
+    // the bucket count must be worked out again
+    void weightsChanged() { m_maxWeight = -1; }
+
+    // Searches from source until target's bucket is settled, or over the
+    // whole graph for a negative target; returns whether target was reached
+    bool route(int source, int target = -1, ThreadPool* pool = nullptr);
+
+    Distance distance(int v) const
+        { return m_distance[v].load(std::memory_order_relaxed); }
+    int  predecessorEdge(int v) const { return m_predecessor[v]; }
+    bool isReached(int v) const { return distance(v) != Unreachable; }
+
+    // Edge indices of the path found to target, ordered start to end
+    std::vector<int> path(int target) const;
+
+    int settledCount() const { return m_settled; }
+    int bucketCount() const { return m_buckets; }
+    int usedDelta() const { return m_usedDelta; }
+
+private:
+    void measureWeights();
+    void relax(const std::vector<int>& nodes, bool light, ThreadPool* pool);
+    int  collect();
+    void buildPredecessors(int source, ThreadPool* pool);
+
+    static void forEachChunk(int count, ThreadPool* pool,
+        const std::function<void (int, int, int)>& task);
+
+private:
+    const RoutingGraph*                 m_graph;
+    int                                 m_delta;
+    int                                 m_usedDelta;
+
+    // Worked out from the graph on the first search after it changes
+    int                                 m_maxWeight;
+    int                                 m_autoDelta;
+
+    std::vector<std::atomic<Distance> > m_distance;
+    std::vector<int>                    m_predecessor;
+
+    // Every node the last search gave a distance, each once
+    std::vector<int>                    m_reached;
+    std::vector<std::vector<int> >      m_newlyReached;
+
+    // Cyclic array of buckets; slot i % size holds bucket i
+    std::vector<std::vector<int> >      m_bucket;
+    std::vector<std::vector<int> >      m_improved;
+    std::vector<bool>                   m_inFrontier;
+    std::vector<bool>                   m_inBucket;
+
+    int                                 m_settled;
+    int                                 m_buckets;
+};
+
+
+#endif  /* !DELTASTEPPINGENGINE_H */
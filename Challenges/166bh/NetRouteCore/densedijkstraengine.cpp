@@ -0,0 +1,246 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "densedijkstraengine.h"
+
+DenseDijkstraEngine::DenseDijkstraEngine()
+    : m_graph(nullptr)
+    , m_vertexCount(0)
+    , m_stride(0)
+    , m_settled(0)
+{
+}
+
+void DenseDijkstraEngine::resize(int vertexCount)
+{
+    m_vertexCount = vertexCount;
+    m_stride      = (vertexCount + LaneCount - 1) / LaneCount * LaneCount;
+
+    // Padding cells stay unreachable, so the SIMD loops need no tails
+    m_weights.assign(static_cast<size_t>(m_stride) * m_stride, Unreachable);
+    m_distance.assign(m_stride, Unreachable);
+    m_key.assign(m_stride, Unreachable);
+    m_predecessor.assign(m_stride, -1);
+    m_settled = 0;
+}
+
+void DenseDijkstraEngine::setWeight(int from, int to, Distance weight)
+{
+    Distance& cell = m_weights[static_cast<size_t>(from) * m_stride + to];
+    cell = std::min(cell, weight);
+}
+
+void DenseDijkstraEngine::updateWeight(int from, int to)
+{
+    Distance& cell = m_weights[static_cast<size_t>(from) * m_stride + to];
+    cell = Unreachable;
+
+    int last = m_graph->lastArc(from);
+    for (int a = m_graph->firstArc(from); a < last; ++a) {
+        if (m_graph->arcTarget(a) == to) {
+            cell = std::min(cell, m_graph->arcWeight(a));
+        }
+    }
+}
+
+bool DenseDijkstraEngine::route(int source, int target /* = -1 */)
+{
+    // Every search touches the whole matrix anyway, so reset everything
+    std::fill(m_distance.begin(), m_distance.end(), Unreachable);
+    std::fill(m_key.begin(), m_key.end(), Unreachable);
+    std::fill(m_predecessor.begin(), m_predecessor.end(), -1);
+    m_settled = 0;
+
+    m_distance[source] = 0;
+    m_key[source]      = 0;
+
+    for (;;) {
+        int current = closest();
+        if (current < 0) {
+            break;
+        }
+
+        m_key[current] = Unreachable;
+        m_settled += 1;
+
+        // If we hit the target, we can stop
+        if (current == target) {
+            return true;
+        }
+
+        relaxRow(current);
+    }
+
+    return target < 0 && m_settled > 0;
+}
+
+std::vector<int> DenseDijkstraEngine::path(int target) const
+{
+    std::vector<int> edges;
+
+    // Walk backwards from the target to the source, picking the edge that
+    // each hop's matrix cell came from
+    for (int v = target; m_predecessor[v] >= 0; v = m_predecessor[v]) {
+        int      u      = m_predecessor[v];
+        Distance weight = m_weights[static_cast<size_t>(u) * m_stride + v];
+        int      best   = -1;
+
+        int last = m_graph->lastArc(u);
+        for (int a = m_graph->firstArc(u); a < last; ++a) {
+            if (m_graph->arcTarget(a) == v &&
+                    m_graph->arcWeight(a) == weight &&
+                    (best < 0 || m_graph->arcEdge(a) < best)) {
+                best = m_graph->arcEdge(a);
+            }
+        }
+        edges.push_back(best);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return edges;
+}
+
+int DenseDijkstraEngine::closest() const
+{
+    const Distance* key = m_key.data();
+    Distance        best;
+    int             j = 0;
+
+    // Smallest key first...
+#if defined(__AVX2__)
+    __m256i vbest = _mm256_set1_epi32(Unreachable);
+    for (; j < m_stride; j += 8) {
+        vbest = _mm256_min_epi32(vbest,
+            _mm256_loadu_si256((const __m256i*) (key + j)));
+    }
+    __m128i half = _mm_min_epi32(_mm256_castsi256_si128(vbest),
+        _mm256_extracti128_si256(vbest, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+    best = _mm_cvtsi128_si32(half);
+#elif defined(__SSE4_1__)
+    __m128i vbest = _mm_set1_epi32(Unreachable);
+    for (; j < m_stride; j += 4) {
+        vbest = _mm_min_epi32(vbest,
+            _mm_loadu_si128((const __m128i*) (key + j)));
+    }
+    vbest = _mm_min_epi32(vbest, _mm_shuffle_epi32(vbest, 0x4e));
+    vbest = _mm_min_epi32(vbest, _mm_shuffle_epi32(vbest, 0xb1));
+    best  = _mm_cvtsi128_si32(vbest);
+#else
+    best = Unreachable;
+    for (; j < m_stride; ++j) {
+        best = std::min(best, key[j]);
+    }
+#endif
+
+    if (best == Unreachable) {
+        return -1;
+    }
+
+    // ...then the lowest node that holds it
+#if defined(__AVX2__)
+    __m256i vtarget = _mm256_set1_epi32(best);
+    for (j = 0; j < m_stride; j += 8) {
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(
+            _mm256_loadu_si256((const __m256i*) (key + j)), vtarget)));
+        if (mask) {
+            return j + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE4_1__)
+    __m128i vtarget = _mm_set1_epi32(best);
+    for (j = 0; j < m_stride; j += 4) {
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(
+            _mm_loadu_si128((const __m128i*) (key + j)), vtarget)));
+        if (mask) {
+            return j + __builtin_ctz(mask);
+        }
+    }
+#else
+    for (j = 0; j < m_stride; ++j) {
+        if (key[j] == best) {
+            return j;
+        }
+    }
+#endif
+
+    return -1;
+}
+
+void DenseDijkstraEngine::relaxRow(int v)
+{
+    const Distance* row  = m_weights.data() + static_cast<size_t>(v) * m_stride;
+    Distance*       dist = m_distance.data();
+    Distance*       key  = m_key.data();
+    int*            pred = m_predecessor.data();
+    Distance        dv   = dist[v];
+    int             j    = 0;
+
+    // A cell can only be used if adding it cannot overflow; settled nodes
+    // are never improved upon, so they need no special treatment
+#if defined(__AVX2__)
+    __m256i vdv    = _mm256_set1_epi32(dv);
+    __m256i vlimit = _mm256_set1_epi32(Unreachable - dv);
+    __m256i vv     = _mm256_set1_epi32(v);
+    for (; j < m_stride; j += 8) {
+        __m256i w      = _mm256_loadu_si256((const __m256i*) (row + j));
+        __m256i cur    = _mm256_loadu_si256((const __m256i*) (dist + j));
+        __m256i viaV   = _mm256_add_epi32(vdv, w);
+        __m256i better = _mm256_andnot_si256(_mm256_cmpgt_epi32(w, vlimit),
+            _mm256_cmpgt_epi32(cur, viaV));
+        if (_mm256_testz_si256(better, better)) {
+            continue;
+        }
+
+        _mm256_storeu_si256((__m256i*) (dist + j),
+            _mm256_blendv_epi8(cur, viaV, better));
+        _mm256_storeu_si256((__m256i*) (key + j), _mm256_blendv_epi8(
+            _mm256_loadu_si256((const __m256i*) (key + j)), viaV, better));
+        _mm256_storeu_si256((__m256i*) (pred + j), _mm256_blendv_epi8(
+            _mm256_loadu_si256((const __m256i*) (pred + j)), vv, better));
+    }
+#elif defined(__SSE4_1__)
+    __m128i vdv    = _mm_set1_epi32(dv);
+    __m128i vlimit = _mm_set1_epi32(Unreachable - dv);
+    __m128i vv     = _mm_set1_epi32(v);
+    for (; j < m_stride; j += 4) {
+        __m128i w      = _mm_loadu_si128((const __m128i*) (row + j));
+        __m128i cur    = _mm_loadu_si128((const __m128i*) (dist + j));
+        __m128i viaV   = _mm_add_epi32(vdv, w);
+        __m128i better = _mm_andnot_si128(_mm_cmpgt_epi32(w, vlimit),
+            _mm_cmpgt_epi32(cur, viaV));
+        if (_mm_testz_si128(better, better)) {
+            continue;
+        }
+
+        _mm_storeu_si128((__m128i*) (dist + j),
+            _mm_blendv_epi8(cur, viaV, better));
+        _mm_storeu_si128((__m128i*) (key + j), _mm_blendv_epi8(
+            _mm_loadu_si128((const __m128i*) (key + j)), viaV, better));
+        _mm_storeu_si128((__m128i*) (pred + j), _mm_blendv_epi8(
+            _mm_loadu_si128((const __m128i*) (pred + j)), vv, better));
+    }
+#endif
+    for (; j < m_stride; ++j) {
+        if (row[j] > Unreachable - dv || dv + row[j] >= dist[j]) {
+            continue;
+        }
+
+        dist[j] = dv + row[j];
+        key[j]  = dist[j];
+        pred[j] = v;
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef DENSEDIJKSTRAENGINE_H
+#define DENSEDIJKSTRAENGINE_H
+
+#include <vector>
+
+#include "routinggraph.h"
+
+
+// O(V^2) Dijkstra straight over the adjacency matrix, for networks where
+// most of the cells hold a link and a heap would only slow things down.
+//
+// The matrix is row-major with every row padded to a whole number of SIMD
+// lanes.  It is the engine's own copy, filled from the parsed links once the
+// network is built, and only for networks dense enough to route over it.
+// Each step finds the closest unsettled node with a vectorised
+// min-reduction over a key array, then relaxes that node's whole row at
+// once.  Both loops use AVX2 or SSE4.1 when the compiler targets them.
+//
+// Settled nodes only remember the node they were reached from.  path()
+// turns each hop back into the lightest matching edge of the RoutingGraph.
+class DenseDijkstraEngine
+{
+public:
+    DenseDijkstraEngine();
+
+    // Empties the matrix and sizes it for vertexCount nodes
+    void resize(int vertexCount);
+    void clear() { resize(0); }
+
+    int vertexCount() const { return m_vertexCount; }
+
+    // Records a from -> to link, keeping the lighter of any parallel links
+    void setWeight(int from, int to, Distance weight);
+
+    // Graph used to map routes back onto edges and to refresh edited cells
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph) { m_graph = graph; }
+
+    // Re-reads the from -> to cell from the graph after a link edit
+    void updateWeight(int from, int to);
+
+    // Searches from source, stopping as soon as target is settled.  Passing
+    // a negative target settles everything reachable.  Returns whether
+    // target (or, for a full search, anything) was reached.
+    bool route(int source, int target = -1);
+
+    Distance distance(int v) const { return m_distance[v]; }
+    bool isReached(int v) const { return m_distance[v] != Unreachable; }
+
+    // Edge indices of the path found to target, ordered start to end
+    std::vector<int> path(int target) const;
+
+    int settledCount() const { return m_settled; }
+
+    // Row padding, in matrix cells
+    static const int LaneCount = 8;
+
+private:
+    int  closest() const;
+    void relaxRow(int v);
+
+private:
+    const RoutingGraph*     m_graph;
+    int                     m_vertexCount;
+    int                     m_stride;
+
+    // Row-major weights; Unreachable where there is no link
+    std::vector<Distance>   m_weights;
+
+    // Per-query state, padded to the stride.  Keys mirror the distances of
+    // the nodes still queued and are Unreachable for everything else.
+    std::vector<Distance>   m_distance;
+    std::vector<Distance>   m_key;
+    std::vector<int>        m_predecessor;
+    int                     m_settled;
+};
+
+
+#endif  /* !DENSEDIJKSTRAENGINE_H */
@@ -0,0 +1,117 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "dijkstraengine.h"
+
+DijkstraEngine::DijkstraEngine(const RoutingGraph* graph /* = nullptr */)
+    : m_graph(nullptr)
+    , m_settled(0)
+{
+    setGraph(graph);
+}
+
+void DijkstraEngine::setGraph(const RoutingGraph* graph)
+{
+    int n = graph ? graph->vertexCount() : 0;
+
+    m_graph = graph;
+    m_distance.assign(n, Unreachable);
+    m_predecessor.assign(n, -1);
+    m_touched.clear();
+    m_heap.resize(n);
+    m_settled = 0;
+}
+
+bool DijkstraEngine::route(int source, int target /* = -1 */)
+{
+    return search<true>(source, target);
+}
+
+void DijkstraEngine::routeBackward(int target)
+{
+    search<false>(target, -1);
+}
+
+std::vector<int> DijkstraEngine::path(int target) const
+{
+    std::vector<int> edges;
+
+    // Walk backwards from the target to the source, then flip it over
+    for (int e = m_predecessor[target]; e >= 0;
+            e = m_predecessor[m_graph->edge(e).source]) {
+        edges.push_back(e);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return edges;
+}
+
+template <bool Forward>
+bool DijkstraEngine::search(int root, int stop)
+{
+    reset();
+
+    // Seed the search with the root node
+    m_distance[root] = 0;
+    m_touched.push_back(root);
+    m_heap.push(root, 0);
+
+    while (!m_heap.empty()) {
+        int      current = m_heap.pop();
+        Distance dist    = m_distance[current];
+
+        m_settled += 1;
+
+        // If we hit the target, we can stop
+        if (current == stop) {
+            return true;
+        }
+
+        // Visit the neighbours
+        int last = Forward ? m_graph->lastArc(current)
+                           : m_graph->lastInArc(current);
+        int a    = Forward ? m_graph->firstArc(current)
+                           : m_graph->firstInArc(current);
+        for (; a < last; ++a) {
+            int weight = Forward ? m_graph->arcWeight(a)
+                                 : m_graph->inArcWeight(a);
+            if (weight > Unreachable - dist) {
+                continue;
+            }
+
+            int      neighbour = Forward ? m_graph->arcTarget(a)
+                                         : m_graph->inArcSource(a);
+            Distance newDist   = dist + weight;
+            if (newDist < m_distance[neighbour]) {
+                if (m_distance[neighbour] == Unreachable) {
+                    m_touched.push_back(neighbour);
+                }
+
+                m_distance[neighbour]    = newDist;
+                m_predecessor[neighbour] = Forward ? m_graph->arcEdge(a)
+                                                   : m_graph->inArcEdge(a);
+                m_heap.push(neighbour, newDist);
+            }
+        }
+    }
+
+    return stop < 0 ? m_settled > 0 : isReached(stop);
+}
+
+void DijkstraEngine::reset()
+{
+    // Only undo what the previous search actually wrote
+    for (size_t i = 0; i < m_touched.size(); ++i) {
+        m_distance[m_touched[i]]    = Unreachable;
+        m_predecessor[m_touched[i]] = -1;
+    }
+    m_touched.clear();
+    m_heap.clear();
+    m_settled = 0;
+}
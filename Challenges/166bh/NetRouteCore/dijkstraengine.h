@@ -0,0 +1,65 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef DIJKSTRAENGINE_H
+#define DIJKSTRAENGINE_H
+
+#include <vector>
+
+#include "indexedheap.h"
+#include "routinggraph.h"
+
+
+// Heap-based Dijkstra over a RoutingGraph.  Distances and predecessor edges
+// live in flat arrays indexed by vertex, and only the entries touched by a
+// search are reset before the next one, so an engine can be reused cheaply
+// for many queries against the same graph.
+class DijkstraEngine
+{
+public:
+    DijkstraEngine(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Searches from source, stopping as soon as target is settled.  Passing
+    // a negative target builds the complete shortest-path tree.  Returns
+    // whether target (or, for a full tree, anything) was reached.
+    bool route(int source, int target = -1);
+
+    // Builds the complete tree of shortest paths into target by following
+    // incoming arcs; distance(v) is then the cost of getting from v to target
+    // and predecessorEdge(v) the first edge of that route.
+    void routeBackward(int target);
+
+    Distance distance(int v) const { return m_distance[v]; }
+    int  predecessorEdge(int v) const { return m_predecessor[v]; }
+    bool isReached(int v) const { return m_distance[v] != Unreachable; }
+
+    // Edge indices of the path found to target, ordered start to end
+    std::vector<int> path(int target) const;
+
+    int settledCount() const { return m_settled; }
+
+private:
+    void reset();
+
+    template <bool Forward>
+    bool search(int root, int stop);
+
+private:
+    const RoutingGraph*     m_graph;
+
+    std::vector<Distance>   m_distance;
+    std::vector<int>        m_predecessor;
+    std::vector<int>        m_touched;
+    IndexedHeap             m_heap;
+    int                     m_settled;
+};
+
+
+#endif  /* !DIJKSTRAENGINE_H */
@@ -0,0 +1,843 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <boost/random.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/kamada_kawai_spring_layout.hpp>
+#include <boost/graph/property_maps/constant_property_map.hpp>
+#include <boost/graph/random_layout.hpp>
+#include <boost/graph/topology.hpp>
+
+#include "graphlayout.h"
+#include "threadpool.h"
+
+// Boost.Graph stuff
+typedef boost::rand48 RandomNumberGenerator;
+typedef boost::rectangle_topology<RandomNumberGenerator> Topology;
+typedef Topology::point TopologicalPoint;
+
+typedef std::chrono::steady_clock Clock;
+
+typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS,
+    boost::no_property, boost::no_property, boost::no_property, boost::listS>
+        LayoutGraph;
+typedef LayoutGraph::vertex_descriptor LayoutVertex;
+typedef LayoutGraph::edge_descriptor LayoutEdge;
+
+// Boost.Graph's handle on the positions: reads and writes go straight to the
+// x, y pairs, so there is nothing to copy in before a layout or out after
+class PositionMap
+{
+public:
+    class Reference
+    {
+    public:
+        explicit Reference(double* xy) : m_xy(xy) {}
+
+        operator TopologicalPoint() const
+        {
+            TopologicalPoint point;
+            point[0] = m_xy[0];
+            point[1] = m_xy[1];
+            return point;
+        }
+
+        Reference& operator=(const TopologicalPoint& point)
+        {
+            m_xy[0] = point[0];
+            m_xy[1] = point[1];
+            return *this;
+        }
+
+    private:
+        double* m_xy;
+    };
+
+    typedef LayoutVertex                        key_type;
+    typedef TopologicalPoint                    value_type;
+    typedef Reference                           reference;
+    typedef boost::read_write_property_map_tag  category;
+
+    explicit PositionMap(std::vector<double>& positions)
+        : m_positions(&positions)
+    {
+    }
+
+    Reference operator[](LayoutVertex v) const
+        { return Reference(&(*m_positions)[2 * v]); }
+
+private:
+    std::vector<double>* m_positions;
+};
+
+inline TopologicalPoint get(const PositionMap& map, LayoutVertex v)
+{
+    return map[v];
+}
+
+inline void put(const PositionMap& map, LayoutVertex v,
+    const TopologicalPoint& point)
+{
+    map[v] = point;
+}
+
+// Every link counts as the same length
+typedef boost::constant_property_map<LayoutEdge, double> UnitWeightMap;
+
+template <typename T = double>
+class MaxIterationsLayoutTolerance : public boost::layout_tolerance<T>
+{
+    int m_currentIteration;
+    int m_maxIterations;
+    JobProgress* m_progress;
+
+public:
+    MaxIterationsLayoutTolerance(int maxIterations, const T& t = T(0.001),
+            JobProgress* progress = nullptr) :
+        boost::layout_tolerance<T>(t),
+        m_currentIteration(0),
+        m_maxIterations(maxIterations),
+        m_progress(progress)
+    {
+    }
+
+    // Actual function we care about
+    template <typename Graph>
+    bool operator()(T delta_p,
+                    typename boost::graph_traits< Graph >::vertex_descriptor p,
+                    const Graph & g,
+                    bool global)
+    {
+        // Cancelling ends both the inner and outer loops at once.  The
+        // all-pairs distances come first, and take a while, so the total is
+        // only given once the moves begin.
+        if (m_progress) {
+            if (m_progress->isCancelled()) {
+                return true;
+            }
+            if (m_currentIteration == 0) {
+                m_progress->setTotal(m_maxIterations);
+            }
+            m_progress->advance();
+        }
+
+        if (m_currentIteration < m_maxIterations) {
+            m_currentIteration += 1;
+
+            // Do the normal thing
+            return boost::layout_tolerance<T>::operator()(delta_p, p, g,
+                                                          global);
+        } else {
+            // Skip out early
+            return true;
+        }
+    }
+};
+
+// Fruchterman-Reingold settings: how small a quadtree cell has to look from
+// a node, as a fraction of its distance, before its nodes repel as one; how
+// far a node may move in the first iteration, as a fraction of the box; and
+// how finely the quadtree splits nodes that are almost on top of each other
+static const double BarnesHutTheta     = 0.8;
+static const double InitialTemperature = 0.1;
+static const int    MaxQuadTreeDepth   = 32;
+
+// Nodes repelled per pool task
+static const int    ChunkSize          = 256;
+
+// Multilevel settings: coarsening stops at this many nodes, or once a level
+// keeps more than the given share of the one below.  The coarsest level gets
+// the full iteration budget and each finer one a share of it, starting from
+// a temperature in ideal link lengths; nodes leave their group's position
+// with a jitter of up to the given fraction of a link length.
+static const int    CoarsestSize         = 64;
+static const double MinCoarsening        = 0.8;
+static const int    RefineIterationShare = 4;
+static const double RefineTemperature    = 2.0;
+static const double ProlongJitter        = 0.1;
+
+// Barnes-Hut quadtree over node positions, rebuilt every iteration.  Each
+// cell knows how many nodes lie under it and where their centre is.
+class QuadTree
+{
+public:
+    void build(const std::vector<double>& positions);
+
+    // Adds the repulsion on node v from every other node, k2 / d each
+    void repel(int v, double k2, double& fx, double& fy) const;
+
+private:
+    struct Cell
+    {
+        double  left;
+        double  top;
+        double  size;
+        double  x;              // centre of the nodes under the cell
+        double  y;
+        int     count;
+        int     body;           // the node, if there is only one
+        int     children[4];    // -1 where a quadrant is empty
+        bool    leaf;
+    };
+
+    int buildCell(int* first, int* last, double left, double top,
+        double size, int depth);
+
+private:
+    const std::vector<double>*  m_positions;
+    std::vector<Cell>           m_cells;
+    std::vector<int>            m_order;
+};
+
+void QuadTree::build(const std::vector<double>& positions)
+{
+    int n = static_cast<int>(positions.size()) / 2;
+
+    m_positions = &positions;
+    m_cells.clear();
+    m_order.resize(n);
+    if (n == 0) {
+        return;
+    }
+
+    // The root is the smallest square around every node
+    double left   = positions[0];
+    double top    = positions[1];
+    double right  = left;
+    double bottom = top;
+    for (int v = 0; v < n; ++v) {
+        m_order[v] = v;
+        left   = std::min(left,   positions[2 * v]);
+        right  = std::max(right,  positions[2 * v]);
+        top    = std::min(top,    positions[2 * v + 1]);
+        bottom = std::max(bottom, positions[2 * v + 1]);
+    }
+
+    double size = std::max(right - left, bottom - top);
+    buildCell(m_order.data(), m_order.data() + n, left, top,
+        size > 0.0 ? size * (1.0 + 1e-9) : 1.0, 0);
+}
+
+int QuadTree::buildCell(int* first, int* last, double left, double top,
+    double size, int depth)
+{
+    const std::vector<double>& positions = *m_positions;
+
+    Cell cell;
+    cell.left  = left;
+    cell.top   = top;
+    cell.size  = size;
+    cell.x     = 0.0;
+    cell.y     = 0.0;
+    cell.count = static_cast<int>(last - first);
+    cell.body  = cell.count == 1 ? *first : -1;
+    cell.leaf  = cell.count == 1 || depth == MaxQuadTreeDepth;
+    std::fill(cell.children, cell.children + 4, -1);
+
+    for (int* it = first; it != last; ++it) {
+        cell.x += positions[2 * *it];
+        cell.y += positions[2 * *it + 1];
+    }
+    cell.x /= cell.count;
+    cell.y /= cell.count;
+
+    int index = static_cast<int>(m_cells.size());
+    m_cells.push_back(cell);
+    if (cell.leaf) {
+        return index;
+    }
+
+    // Split into quadrants: left then right, each top then bottom
+    double half    = size / 2.0;
+    double middleX = left + half;
+    double middleY = top + half;
+
+    int* bounds[5];
+    bounds[0] = first;
+    bounds[2] = std::partition(first, last, [&positions, middleX] (int v) {
+        return positions[2 * v] < middleX;
+    });
+    bounds[4] = last;
+    for (int side = 0; side < 2; ++side) {
+        bounds[2 * side + 1] = std::partition(bounds[2 * side],
+            bounds[2 * side + 2], [&positions, middleY] (int v) {
+                return positions[2 * v + 1] < middleY;
+            });
+    }
+
+    for (int q = 0; q < 4; ++q) {
+        if (bounds[q] != bounds[q + 1]) {
+            int child = buildCell(bounds[q], bounds[q + 1],
+                q < 2 ? left : middleX, q % 2 == 0 ? top : middleY, half,
+                depth + 1);
+            m_cells[index].children[q] = child;
+        }
+    }
+
+    return index;
+}
+
+void QuadTree::repel(int v, double k2, double& fx, double& fy) const
+{
+    static const double theta2 = BarnesHutTheta * BarnesHutTheta;
+
+    if (m_cells.empty()) {
+        return;
+    }
+
+    double x = (*m_positions)[2 * v];
+    double y = (*m_positions)[2 * v + 1];
+
+    // Deep enough for any path down the tree, with the siblings passed
+    int stack[4 * MaxQuadTreeDepth + 4];
+    int depth = 0;
+
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const Cell& cell = m_cells[stack[--depth]];
+
+        double dx = x - cell.x;
+        double dy = y - cell.y;
+        double d2 = dx * dx + dy * dy;
+
+        // A cell holding v is never taken as one body, or v would repel
+        // itself
+        bool inside = x >= cell.left && x < cell.left + cell.size &&
+                      y >= cell.top  && y < cell.top  + cell.size;
+        if (cell.leaf || (!inside && cell.size * cell.size < theta2 * d2)) {
+            // Nodes on top of v push it nowhere in particular
+            if (cell.body != v && d2 > 0.0) {
+                double f = cell.count * k2 / d2;
+                fx += dx * f;
+                fy += dy * f;
+            }
+            continue;
+        }
+
+        for (int q = 0; q < 4; ++q) {
+            if (cell.children[q] >= 0) {
+                stack[depth++] = cell.children[q];
+            }
+        }
+    }
+}
+
+// One level of the multilevel layout's hierarchy.  Level 0 is the network
+// itself; above it there is a node per group of the finer level's nodes,
+// and a link wherever two groups were linked.  Every level holds each pair
+// of linked nodes once, whichever way and however often they are linked,
+// so that the same force model applies all the way down.
+struct LayoutLevel
+{
+    int                 vertexCount;
+    std::vector<int>    ends;           // source, target pairs
+
+    LayoutLevel() : vertexCount(0) {}
+
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        for (size_t i = 0; i < ends.size(); i += 2) {
+            visit(ends[i], ends[i + 1]);
+        }
+    }
+
+    // Sets the links from keys of (lower << 32 | higher) node numbers
+    void setLinks(std::vector<uint64_t>& keys)
+    {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        ends.resize(2 * keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ends[2 * i]     = static_cast<int>(keys[i] >> 32);
+            ends[2 * i + 1] = static_cast<int>(keys[i] & 0xFFFFFFFFu);
+        }
+    }
+};
+
+// Level 0: the links of the network, skipping removed ones and loops
+static void networkLevel(const RoutingGraph& graph, LayoutLevel& level)
+{
+    std::vector<uint64_t> keys;
+    for (int e = 0; e < graph.edgeCount(); ++e) {
+        uint64_t s = graph.edge(e).source;
+        uint64_t t = graph.edge(e).target;
+        if (graph.hasEdge(e) && s != t) {
+            keys.push_back(std::min(s, t) << 32 | std::max(s, t));
+        }
+    }
+
+    level.vertexCount = graph.vertexCount();
+    level.setLinks(keys);
+}
+
+// Groups the nodes of a level in pairs along a random maximal matching, then
+// folds each node left unmatched into a neighbour's group, so that a hub
+// takes its leaves with it rather than stalling the coarsening
+static void coarsen(const LayoutLevel& fine, RandomNumberGenerator& rng,
+    std::vector<int>& parent, LayoutLevel& coarse)
+{
+    int                     vertexCount = fine.vertexCount;
+    const std::vector<int>& ends        = fine.ends;
+
+    std::vector<int> order(ends.size() / 2);
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    boost::uniform_int<size_t> pick;
+    for (size_t i = order.size(); i > 1; --i) {
+        std::swap(order[i - 1], order[pick(rng, i)]);
+    }
+
+    int count = 0;
+    parent.assign(vertexCount, -1);
+    for (size_t i = 0; i < order.size(); ++i) {
+        int s = ends[2 * order[i]];
+        int t = ends[2 * order[i] + 1];
+        if (parent[s] < 0 && parent[t] < 0) {
+            parent[s] = parent[t] = count++;
+        }
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        int s = ends[2 * order[i]];
+        int t = ends[2 * order[i] + 1];
+        if (parent[s] < 0 && parent[t] >= 0) {
+            parent[s] = parent[t];
+        } else if (parent[t] < 0 && parent[s] >= 0) {
+            parent[t] = parent[s];
+        }
+    }
+    for (int v = 0; v < vertexCount; ++v) {
+        if (parent[v] < 0) {
+            parent[v] = count++;
+        }
+    }
+
+    // Links between groups, once each however many joined them
+    std::vector<uint64_t> keys;
+    for (size_t i = 0; i < ends.size(); i += 2) {
+        uint64_t s = parent[ends[i]];
+        uint64_t t = parent[ends[i + 1]];
+        if (s != t) {
+            keys.push_back(std::min(s, t) << 32 | std::max(s, t));
+        }
+    }
+
+    coarse.vertexCount = count;
+    coarse.setLinks(keys);
+}
+
+// Up to the given number of Fruchterman-Reingold iterations over positions,
+// in place, cooling linearly from temperature to nothing.  Links pull their
+// ends together by d^2 / k and every pair of nodes pushes apart by k^2 / d,
+// so that linked nodes settle about k apart.  Each iteration advances
+// progress, and the iterations skipped by stopping early are advanced at
+// the end; returns false if cancelled.
+template <typename Links>
+static bool forceDirected(const Links& links, std::vector<double>& positions,
+    double k, double temperature, int iterations, double tolerance,
+    ThreadPool* pool, JobProgress* progress, int& ran)
+{
+    int    n       = static_cast<int>(positions.size()) / 2;
+    double k2      = k * k;
+    double cooling = iterations > 0 ? temperature / iterations : 0.0;
+
+    QuadTree            tree;
+    std::vector<double> force(2 * n);
+
+    // The tree is only read, so nodes are repelled a chunk at a time
+    int chunks = (n + ChunkSize - 1) / ChunkSize;
+    ThreadPool::Task repelTask = [n, k2, &tree, &force] (int chunk, int) {
+        int end = std::min((chunk + 1) * ChunkSize, n);
+        for (int v = chunk * ChunkSize; v < end; ++v) {
+            force[2 * v]     = 0.0;
+            force[2 * v + 1] = 0.0;
+            tree.repel(v, k2, force[2 * v], force[2 * v + 1]);
+        }
+    };
+
+    for (ran = 0; ran < iterations; ++ran) {
+        if (progress && progress->isCancelled()) {
+            return false;
+        }
+
+        tree.build(positions);
+        if (pool) {
+            pool->parallelFor(chunks, repelTask);
+        } else {
+            for (int chunk = 0; chunk < chunks; ++chunk) {
+                repelTask(chunk, 0);
+            }
+        }
+
+        links.forEach([k, &positions, &force] (int s, int t) {
+            double dx = positions[2 * s]     - positions[2 * t];
+            double dy = positions[2 * s + 1] - positions[2 * t + 1];
+            double f  = std::sqrt(dx * dx + dy * dy) / k;
+
+            force[2 * s]     -= dx * f;
+            force[2 * s + 1] -= dy * f;
+            force[2 * t]     += dx * f;
+            force[2 * t + 1] += dy * f;
+        });
+
+        // Each node moves along its force, but no further than the
+        // temperature allows.  There are no walls, which would pile the
+        // outermost nodes up against them; the caller fits the result.
+        double furthest = 0.0;
+        for (int v = 0; v < n; ++v) {
+            double fx = force[2 * v];
+            double fy = force[2 * v + 1];
+            double f  = std::sqrt(fx * fx + fy * fy);
+            if (f == 0.0) {
+                continue;
+            }
+
+            double step = std::min(f, temperature);
+            furthest = std::max(furthest, step);
+
+            positions[2 * v]     += fx * step / f;
+            positions[2 * v + 1] += fy * step / f;
+        }
+
+        temperature -= cooling;
+        if (progress) {
+            progress->advance();
+        }
+        if (furthest < tolerance * k) {
+            ran += 1;
+            break;
+        }
+    }
+
+    if (progress) {
+        progress->advance(iterations - ran);
+    }
+    return true;
+}
+
+// How long the links of a level came out, in ideal lengths
+template <typename Links>
+static void measureLinks(const Links& links,
+    const std::vector<double>& positions, double k,
+    GraphLayout::LevelReport& report)
+{
+    double sum        = 0.0;
+    double sumSquares = 0.0;
+    int    count      = 0;
+
+    links.forEach([&] (int s, int t) {
+        double dx = positions[2 * s]     - positions[2 * t];
+        double dy = positions[2 * s + 1] - positions[2 * t + 1];
+        double d  = std::sqrt(dx * dx + dy * dy) / k;
+
+        sum        += d;
+        sumSquares += d * d;
+        count      += 1;
+    });
+
+    report.edgeCount        = count;
+    report.meanLinkLength   = count > 0 ? sum / count : 0.0;
+    report.linkLengthSpread = count > 0 ? std::sqrt(std::max(
+        sumSquares / count - report.meanLinkLength * report.meanLinkLength,
+        0.0)) : 0.0;
+}
+
+// Scales and centres positions to fill the box, keeping their proportions
+static void fitPositions(std::vector<double>& positions, double left,
+    double top, double right, double bottom)
+{
+    int n = static_cast<int>(positions.size()) / 2;
+    if (n == 0) {
+        return;
+    }
+
+    double minX = positions[0];
+    double minY = positions[1];
+    double maxX = minX;
+    double maxY = minY;
+    for (int v = 1; v < n; ++v) {
+        minX = std::min(minX, positions[2 * v]);
+        maxX = std::max(maxX, positions[2 * v]);
+        minY = std::min(minY, positions[2 * v + 1]);
+        maxY = std::max(maxY, positions[2 * v + 1]);
+    }
+
+    double width  = maxX - minX;
+    double height = maxY - minY;
+    double scale  = 0.0;
+    if (width > 0.0 || height > 0.0) {
+        scale = std::min(width  > 0.0 ? (right - left) / width  : HUGE_VAL,
+                         height > 0.0 ? (bottom - top) / height : HUGE_VAL);
+    }
+
+    // Clamped as well, against rounding at the edges
+    double centreX = (minX + maxX) / 2.0;
+    double centreY = (minY + maxY) / 2.0;
+    for (int v = 0; v < n; ++v) {
+        double x = (left + right) / 2.0 + (positions[2 * v] - centreX) * scale;
+        double y = (top + bottom) / 2.0 +
+            (positions[2 * v + 1] - centreY) * scale;
+        positions[2 * v]     = std::min(std::max(x, left), right);
+        positions[2 * v + 1] = std::min(std::max(y, top), bottom);
+    }
+}
+
+// The undirected view: one Boost.Graph edge per live link, and where it is
+struct GraphLayout::View
+{
+    LayoutGraph             graph;
+    std::vector<LayoutEdge> edges;
+    std::vector<bool>       present;
+
+    explicit View(const RoutingGraph& network)
+        : graph(network.vertexCount())
+        , edges(network.edgeCount())
+        , present(network.edgeCount(), false)
+    {
+        for (int e = 0; e < network.edgeCount(); ++e) {
+            if (network.hasEdge(e)) {
+                add(network, e);
+            }
+        }
+    }
+
+    // Edges live in a list, so their descriptors outlast other removals
+    void add(const RoutingGraph& network, int e)
+    {
+        if (e >= static_cast<int>(edges.size())) {
+            edges.resize(e + 1);
+            present.resize(e + 1, false);
+        }
+        edges[e] = boost::add_edge(network.edge(e).source,
+            network.edge(e).target, graph).first;
+        present[e] = true;
+    }
+
+    void remove(int e)
+    {
+        if (e < static_cast<int>(edges.size()) && present[e]) {
+            boost::remove_edge(edges[e], graph);
+            present[e] = false;
+        }
+    }
+};
+
+GraphLayout::GraphLayout()
+    : m_graph(nullptr)
+{
+}
+
+GraphLayout::~GraphLayout()
+{
+}
+
+void GraphLayout::setGraph(const RoutingGraph* graph)
+{
+    m_graph = graph;
+    m_view.reset();
+    m_positions.clear();
+    m_levels.clear();
+}
+
+void GraphLayout::addEdge(int e)
+{
+    if (m_view) {
+        m_view->add(*m_graph, e);
+    }
+}
+
+void GraphLayout::removeEdge(int e)
+{
+    if (m_view) {
+        m_view->remove(e);
+    }
+}
+
+void GraphLayout::clear()
+{
+    setGraph(nullptr);
+}
+
+void GraphLayout::randomLayout(double left, double top, double right,
+    double bottom, unsigned seed)
+{
+    RandomNumberGenerator rng(seed);
+    Topology              topology(rng, left, top, right, bottom);
+    PositionMap           positions(m_positions);
+
+    // As boost::random_graph_layout does, without needing the view
+    int n = m_graph ? m_graph->vertexCount() : 0;
+    m_positions.resize(2 * n);
+    for (int v = 0; v < n; ++v) {
+        put(positions, v, topology.random_point());
+    }
+}
+
+bool GraphLayout::springLayout(double left, double top, double right,
+    double bottom, int maxIterations, double tolerance, unsigned seed,
+    JobProgress* progress /* = nullptr */)
+{
+    UnitWeightMap         weights(1.0);
+    RandomNumberGenerator rng(seed);
+    Topology              topology(rng, left, top, right, bottom);
+    PositionMap           positions(m_positions);
+
+    randomLayout(left, top, right, bottom, seed);
+    if (!m_graph) {
+        return true;
+    }
+    if (!m_view) {
+        m_view.reset(new View(*m_graph));
+    }
+
+    MaxIterationsLayoutTolerance<double> done(
+        m_graph->vertexCount() * maxIterations, tolerance, progress);
+
+    // Wherever a cancelled layout got to is still a layout
+    boost::kamada_kawai_spring_layout(m_view->graph, positions, weights,
+        topology, boost::side_length(right - left), done);
+    return !progress || !progress->isCancelled();
+}
+
+bool GraphLayout::forceLayout(double left, double top, double right,
+    double bottom, int maxIterations, double tolerance, unsigned seed,
+    JobProgress* progress /* = nullptr */, ThreadPool* pool /* = nullptr */)
+{
+    randomLayout(left, top, right, bottom, seed);
+    if (!m_graph || m_graph->vertexCount() == 0) {
+        return true;
+    }
+
+    double k = std::sqrt((right - left) * (bottom - top) /
+        m_graph->vertexCount());
+    int    iterations;
+
+    if (progress) {
+        progress->setTotal(maxIterations);
+    }
+    LayoutLevel network;
+    networkLevel(*m_graph, network);
+    bool finished = forceDirected(network, m_positions, k,
+        InitialTemperature * (right - left), maxIterations, tolerance, pool,
+        progress, iterations);
+
+    fitPositions(m_positions, left, top, right, bottom);
+    return finished;
+}
+
+bool GraphLayout::multilevelLayout(double left, double top, double right,
+    double bottom, int maxIterations, double tolerance, unsigned seed,
+    JobProgress* progress /* = nullptr */, ThreadPool* pool /* = nullptr */)
+{
+    m_levels.clear();
+    if (!m_graph || m_graph->vertexCount() == 0) {
+        randomLayout(left, top, right, bottom, seed);
+        return true;
+    }
+
+    RandomNumberGenerator rng(seed);
+    LayoutLevel           network;
+    networkLevel(*m_graph, network);
+
+    // Coarsen until the graph is small enough to lay out from scratch, or
+    // stops shrinking.  Level 0 is the network itself; parents[i] takes the
+    // nodes of level i to those of level i + 1.
+    std::vector<LayoutLevel>        coarse;
+    std::vector<std::vector<int> >  parents;
+    int                             count = m_graph->vertexCount();
+    while (count > CoarsestSize) {
+        coarse.push_back(LayoutLevel());
+        parents.push_back(std::vector<int>());
+        coarsen(coarse.size() == 1 ? network : coarse[coarse.size() - 2],
+            rng, parents.back(), coarse.back());
+
+        if (coarse.back().vertexCount > MinCoarsening * count) {
+            coarse.pop_back();
+            parents.pop_back();
+            break;
+        }
+        count = coarse.back().vertexCount;
+    }
+
+    int levels = static_cast<int>(coarse.size());
+    int refine = std::max(maxIterations / RefineIterationShare, 1);
+    if (progress) {
+        progress->setTotal(maxIterations + levels * refine);
+    }
+
+    // The coarsest level starts from random, every finer one from the level
+    // above, each node where its group was plus a little jitter to part it
+    // from the rest of the group
+    Topology topology(rng, left, top, right, bottom);
+    boost::uniform_real<double> jitter(-ProlongJitter, ProlongJitter);
+
+    std::vector<double> positions(2 * count);
+    std::vector<double> finer;
+    PositionMap         map(positions);
+    for (int v = 0; v < count; ++v) {
+        put(map, v, topology.random_point());
+    }
+
+    bool finished = true;
+    for (int level = levels; level >= 0; --level) {
+        Clock::time_point start = Clock::now();
+
+        count = level == 0 ? m_graph->vertexCount() :
+                             coarse[level - 1].vertexCount;
+        double k = std::sqrt((right - left) * (bottom - top) / count);
+
+        if (level < levels) {
+            const std::vector<int>& parent = parents[level];
+
+            finer.resize(2 * count);
+            for (int v = 0; v < count; ++v) {
+                finer[2 * v]     = positions[2 * parent[v]]     +
+                    jitter(rng) * k;
+                finer[2 * v + 1] = positions[2 * parent[v] + 1] +
+                    jitter(rng) * k;
+            }
+            positions.swap(finer);
+        }
+
+        // Once cancelled, the rest of the levels are only carried down
+        double temperature = level == levels ?
+            InitialTemperature * (right - left) : RefineTemperature * k;
+        int    iterations  = 0;
+        if (finished) {
+            finished = level == 0 ?
+                forceDirected(network, positions, k, temperature,
+                    level == levels ? maxIterations : refine, tolerance,
+                    pool, progress, iterations) :
+                forceDirected(coarse[level - 1], positions, k, temperature,
+                    level == levels ? maxIterations : refine, tolerance,
+                    pool, progress, iterations);
+        }
+
+        LevelReport report;
+        report.vertexCount = count;
+        report.iterations  = iterations;
+        report.nanoseconds = std::chrono::duration_cast<
+            std::chrono::nanoseconds>(Clock::now() - start).count();
+        if (level == 0) {
+            measureLinks(network, positions, k, report);
+        } else {
+            measureLinks(coarse[level - 1], positions, k, report);
+        }
+        m_levels.push_back(report);
+    }
+
+    m_positions.swap(positions);
+    fitPositions(m_positions, left, top, right, bottom);
+    return finished;
+}
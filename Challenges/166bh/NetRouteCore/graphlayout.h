@@ -0,0 +1,113 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef GRAPHLAYOUT_H
+#define GRAPHLAYOUT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "jobprogress.h"
+#include "routinggraph.h"
+
+class ThreadPool;
+
+// Coordinates for the nodes of a RoutingGraph, worked out with Boost.Graph or,
+// for the force layout, a Barnes-Hut quadtree of its own.
+// Every layout fits the nodes into the box it is given; the explorer passes
+// the visible part of its view.  Positions are kept as x, y pairs, as a
+// SessionFile stores them, and every layout works on them in place.
+//
+// Kamada-Kawai runs over an undirected Boost.Graph view of the network,
+// built the first time it is needed and then kept in step with the links
+// added and removed, so laying out again copies nothing.
+class GraphLayout
+{
+public:
+    // How one level of a multilevel layout went.  Links are measured in
+    // ideal lengths for the level, so a good layout has a mean close to one
+    // and little spread.
+    struct LevelReport
+    {
+        int         vertexCount;
+        int         edgeCount;
+        int         iterations;
+        int64_t     nanoseconds;
+        double      meanLinkLength;
+        double      linkLengthSpread;   // standard deviation
+    };
+
+    GraphLayout();
+    ~GraphLayout();
+
+    // The graph stays the layout's until it is replaced or cleared; tell it
+    // about every link added to or removed from the graph meanwhile
+    void setGraph(const RoutingGraph* graph);
+    void addEdge(int e);
+    void removeEdge(int e);
+
+    int vertexCount() const
+        { return static_cast<int>(m_positions.size()) / 2; }
+    double x(int v) const { return m_positions[2 * v]; }
+    double y(int v) const { return m_positions[2 * v + 1]; }
+    const std::vector<double>& positions() const { return m_positions; }
+
+    void clear();
+
+    // Scatters the nodes uniformly across the box
+    void randomLayout(double left, double top, double right, double bottom,
+        unsigned seed);
+
+    // Kamada-Kawai from a random start, treating every link as undirected
+    // and of unit length.  Stops once no node moves further than tolerance,
+    // or after maxIterations moves per node.  Each move advances progress,
+    // if given, and cancelling it stops the layout where it stands; returns
+    // false if it was cancelled.
+    bool springLayout(double left, double top, double right, double bottom,
+        int maxIterations, double tolerance, unsigned seed,
+        JobProgress* progress = nullptr);
+
+    // Fruchterman-Reingold from a random start, again treating links as
+    // undirected.  The repulsion between every pair of nodes is summed with
+    // a Barnes-Hut quadtree, so an iteration takes O(V log V) rather than
+    // Kamada-Kawai's O(V^2), and there are no all-pairs distances to hold.
+    // Every node moves once per iteration, which advances progress; stops
+    // once none moves further than tolerance times the ideal link length,
+    // or after maxIterations.  Cancelling works as for springLayout().  The
+    // repulsion is shared across the pool, if given.
+    bool forceLayout(double left, double top, double right, double bottom,
+        int maxIterations, double tolerance, unsigned seed,
+        JobProgress* progress = nullptr, ThreadPool* pool = nullptr);
+
+    // Fruchterman-Reingold over a hierarchy of ever coarser graphs, for
+    // networks too big to settle from a random start.  Each coarser level
+    // collapses a random matching of the one below, folding in the nodes
+    // left over.  The coarsest level is laid out from random with the full
+    // iteration budget.  Each finer level then starts from the one above
+    // and is refined with a quarter of the budget, at a lower temperature.
+    // A cancelled layout carries the positions it reached down to the
+    // network without refining them further.
+    bool multilevelLayout(double left, double top, double right,
+        double bottom, int maxIterations, double tolerance, unsigned seed,
+        JobProgress* progress = nullptr, ThreadPool* pool = nullptr);
+
+    // The last multilevel layout, coarsest level first
+    const std::vector<LevelReport>& levels() const { return m_levels; }
+
+private:
+    struct View;
+
+private:
+    const RoutingGraph*     m_graph;
+    std::unique_ptr<View>   m_view;
+    std::vector<double>     m_positions;
+    std::vector<LevelReport> m_levels;
+};
+
+
+#endif  /* !GRAPHLAYOUT_H */
@@ -0,0 +1,154 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <vector>
+
+#include "routinggraph.h"
+
+
+// Binary min-heap over the vertex indices [0, capacity) that tracks the
+// position of every entry so that keys can be decreased in place.
+class IndexedHeap
+{
+public:
+    IndexedHeap(int capacity = 0) { resize(capacity); }
+
+    void resize(int capacity)
+    {
+        m_entries.clear();
+        m_position.assign(capacity, NotQueued);
+    }
+
+    void clear()
+    {
+        // Only the entries still queued need their positions resetting
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            m_position[m_entries[i].id] = NotQueued;
+        }
+        m_entries.clear();
+    }
+
+    bool empty() const { return m_entries.empty(); }
+    int  size() const { return static_cast<int>(m_entries.size()); }
+    bool contains(int id) const { return m_position[id] >= 0; }
+
+    int      top() const { return m_entries[0].id; }
+    Distance topKey() const { return m_entries[0].key; }
+
+    // Inserts id, or lowers its key if it is already queued with a larger one
+    void push(int id, Distance key)
+    {
+        int pos = m_position[id];
+        if (pos == NotQueued) {
+            pos = static_cast<int>(m_entries.size());
+            m_entries.push_back(Entry(id, key));
+            m_position[id] = pos;
+        } else if (key < m_entries[pos].key) {
+            m_entries[pos].key = key;
+        } else {
+            return;
+        }
+
+        siftUp(pos);
+    }
+
+    // Moves an already queued id to a new key, larger or smaller
+    void update(int id, Distance key)
+    {
+        int pos = m_position[id];
+        if (pos == NotQueued) {
+            push(id, key);
+        } else if (key < m_entries[pos].key) {
+            m_entries[pos].key = key;
+            siftUp(pos);
+        } else {
+            m_entries[pos].key = key;
+            siftDown(pos);
+        }
+    }
+
+    int pop()
+    {
+        int id = m_entries[0].id;
+        m_position[id] = NotQueued;
+
+        Entry last = m_entries.back();
+        m_entries.pop_back();
+        if (!m_entries.empty()) {
+            m_entries[0] = last;
+            m_position[last.id] = 0;
+            siftDown(0);
+        }
+
+        return id;
+    }
+
+private:
+    enum { NotQueued = -1 };
+
+    struct Entry
+    {
+        int         id;
+        Distance    key;
+
+        Entry(int id_ = 0, Distance key_ = 0) : id(id_), key(key_) {}
+    };
+
+    void siftUp(int pos)
+    {
+        Entry entry = m_entries[pos];
+        while (pos > 0) {
+            int parent = (pos - 1) / 2;
+            if (!(entry.key < m_entries[parent].key)) {
+                break;
+            }
+
+            m_entries[pos] = m_entries[parent];
+            m_position[m_entries[pos].id] = pos;
+            pos = parent;
+        }
+
+        m_entries[pos] = entry;
+        m_position[entry.id] = pos;
+    }
+
+    void siftDown(int pos)
+    {
+        int   count = static_cast<int>(m_entries.size());
+        Entry entry = m_entries[pos];
+        for (;;) {
+            int child = 2 * pos + 1;
+            if (child >= count) {
+                break;
+            }
+            if (child + 1 < count &&
+                    m_entries[child + 1].key < m_entries[child].key) {
+                child += 1;
+            }
+            if (!(m_entries[child].key < entry.key)) {
+                break;
+            }
+
+            m_entries[pos] = m_entries[child];
+            m_position[m_entries[pos].id] = pos;
+            pos = child;
+        }
+
+        m_entries[pos] = entry;
+        m_position[entry.id] = pos;
+    }
+
+private:
+    std::vector<Entry>  m_entries;
+    std::vector<int>    m_position;
+};
+
+
+#endif  /* !INDEXEDHEAP_H */
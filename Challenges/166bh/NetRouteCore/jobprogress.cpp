@@ -0,0 +1,41 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "jobprogress.h"
+
+JobProgress::JobProgress()
+    : m_cancelled(false)
+    , m_done(0)
+    , m_total(0)
+{
+}
+
+void JobProgress::reset()
+{
+    m_cancelled = false;
+    m_done      = 0;
+    m_total     = 0;
+}
+
+void JobProgress::setTotal(int64_t total)
+{
+    m_done  = 0;
+    m_total = total;
+}
+
+double JobProgress::fraction() const
+{
+    int64_t total = m_total;
+    if (total <= 0) {
+        return -1.0;
+    }
+
+    // Work that finishes early never reaches its total
+    return std::min(1.0, static_cast<double>(m_done) / total);
+}
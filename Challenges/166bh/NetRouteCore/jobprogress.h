@@ -0,0 +1,43 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef JOBPROGRESS_H
+#define JOBPROGRESS_H
+
+#include <atomic>
+#include <cstdint>
+
+
+// Shared between a thread doing long-running work and one watching it.  The
+// worker advances a count of steps towards a total, if it knows one, and
+// polls for cancellation wherever it can stop cleanly; the watcher reads
+// the fraction done and may ask it to stop.  Nothing here blocks.
+class JobProgress
+{
+public:
+    JobProgress();
+
+    // Ready for the next piece of work: not cancelled, nothing done
+    void reset();
+
+    void cancel() { m_cancelled = true; }
+    bool isCancelled() const { return m_cancelled; }
+
+    void setTotal(int64_t total);
+    void advance(int64_t steps = 1) { m_done += steps; }
+
+    // In [0, 1], or negative while the total is unknown
+    double fraction() const;
+
+private:
+    std::atomic<bool>       m_cancelled;
+    std::atomic<int64_t>    m_done;
+    std::atomic<int64_t>    m_total;
+};
+
+
+#endif  /* !JOBPROGRESS_H */
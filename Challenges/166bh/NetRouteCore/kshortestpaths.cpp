@@ -0,0 +1,251 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <set>
+
+#include "kshortestpaths.h"
+
+// Cheaper first, then fewer hops, then by edges so duplicates compare equal
+bool KShortestPaths::Path::operator<(const Path& other) const
+{
+    if (cost != other.cost) {
+        return cost < other.cost;
+    }
+    if (edges.size() != other.edges.size()) {
+        return edges.size() < other.edges.size();
+    }
+    return edges < other.edges;
+}
+
+void KShortestPaths::Scratch::resize(int vertexCount, int edgeCount)
+{
+    distance.assign(vertexCount, Unreachable);
+    predecessor.assign(vertexCount, -1);
+    touched.clear();
+    heap.resize(vertexCount);
+    blockedNode.assign(vertexCount, false);
+    blockedEdge.assign(edgeCount, false);
+    blockedNodes.clear();
+    blockedEdges.clear();
+    settled = 0;
+}
+
+void KShortestPaths::Scratch::unblock()
+{
+    for (size_t i = 0; i < blockedNodes.size(); ++i) {
+        blockedNode[blockedNodes[i]] = false;
+    }
+    for (size_t i = 0; i < blockedEdges.size(); ++i) {
+        blockedEdge[blockedEdges[i]] = false;
+    }
+    blockedNodes.clear();
+    blockedEdges.clear();
+}
+
+KShortestPaths::KShortestPaths(const RoutingGraph* graph /* = nullptr */)
+    : m_graph(nullptr)
+    , m_settled(0)
+{
+    setGraph(graph);
+}
+
+void KShortestPaths::setGraph(const RoutingGraph* graph)
+{
+    m_graph = graph;
+    m_scratch.clear();
+    clear();
+}
+
+int KShortestPaths::find(int source, int target, int k,
+                         ThreadPool* pool /* = nullptr */)
+{
+    clear();
+    if (!m_graph || k <= 0) {
+        return 0;
+    }
+
+    // Scratch space is sized to the graph, so it is kept between calls
+    int    threads = pool ? pool->threadCount() : 1;
+    size_t edges   = static_cast<size_t>(m_graph->edgeCount());
+    if (static_cast<int>(m_scratch.size()) != threads ||
+            m_scratch[0].blockedEdge.size() != edges) {
+        m_scratch.assign(threads, Scratch());
+        for (int t = 0; t < threads; ++t) {
+            m_scratch[t].resize(m_graph->vertexCount(), m_graph->edgeCount());
+        }
+    }
+    for (int t = 0; t < threads; ++t) {
+        m_scratch[t].settled = 0;
+    }
+
+    // The best route is just the shortest path
+    Path best;
+    if (!search(m_scratch[0], source, target, best)) {
+        m_settled = m_scratch[0].settled;
+        return 0;
+    }
+    m_paths.push_back(best);
+
+    // Candidates for the next route, cheapest first and without duplicates
+    std::set<Path> candidates;
+
+    ThreadPool::Task task = [this, source, target](int root, int thread) {
+        spur(m_scratch[thread], source, target, root);
+    };
+
+    while (pathCount() < k) {
+        // One spur search for every root of the latest route
+        int roots = static_cast<int>(m_paths.back().edges.size());
+        m_spurs.assign(roots, Path());
+        m_spurFound.assign(roots, 0);
+
+        if (pool) {
+            pool->parallelFor(roots, task);
+        } else {
+            for (int root = 0; root < roots; ++root) {
+                task(root, 0);
+            }
+        }
+
+        for (int root = 0; root < roots; ++root) {
+            if (m_spurFound[root]) {
+                candidates.insert(m_spurs[root]);
+            }
+        }
+
+        if (candidates.empty()) {
+            break;
+        }
+        m_paths.push_back(*candidates.begin());
+        candidates.erase(candidates.begin());
+    }
+
+    for (int t = 0; t < threads; ++t) {
+        m_settled += m_scratch[t].settled;
+    }
+
+    return pathCount();
+}
+
+void KShortestPaths::clear()
+{
+    m_paths.clear();
+    m_spurs.clear();
+    m_spurFound.clear();
+    m_settled = 0;
+}
+
+void KShortestPaths::spur(Scratch& scratch, int source, int target, int root)
+{
+    const std::vector<int>& previous = m_paths.back().edges;
+
+    // Walk the root, keeping the spur search off it
+    int      spurNode = source;
+    Distance rootCost = 0;
+    for (int i = 0; i < root; ++i) {
+        scratch.blockedNode[spurNode] = true;
+        scratch.blockedNodes.push_back(spurNode);
+
+        const RoutingEdge& edge = m_graph->edge(previous[i]);
+        rootCost += edge.weight;
+        spurNode  = edge.target;
+    }
+
+    // Routes already taken that share this root may not leave it the same way
+    for (size_t p = 0; p < m_paths.size(); ++p) {
+        const std::vector<int>& other = m_paths[p].edges;
+        if (static_cast<int>(other.size()) > root &&
+                std::equal(previous.begin(), previous.begin() + root,
+                    other.begin()) &&
+                !scratch.blockedEdge[other[root]]) {
+            scratch.blockedEdge[other[root]] = true;
+            scratch.blockedEdges.push_back(other[root]);
+        }
+    }
+
+    Path tail;
+    if (search(scratch, spurNode, target, tail) &&
+            static_cast<long long>(rootCost) + tail.cost < Unreachable) {
+        Path& candidate = m_spurs[root];
+        candidate.cost  = rootCost + tail.cost;
+        candidate.edges.assign(previous.begin(), previous.begin() + root);
+        candidate.edges.insert(candidate.edges.end(), tail.edges.begin(),
+            tail.edges.end());
+        m_spurFound[root] = 1;
+    }
+
+    scratch.unblock();
+}
+
+bool KShortestPaths::search(Scratch& scratch, int from, int target,
+                            Path& path) const
+{
+    // Only undo what the previous search actually wrote
+    for (size_t i = 0; i < scratch.touched.size(); ++i) {
+        scratch.distance[scratch.touched[i]]    = Unreachable;
+        scratch.predecessor[scratch.touched[i]] = -1;
+    }
+    scratch.touched.clear();
+    scratch.heap.clear();
+
+    scratch.distance[from] = 0;
+    scratch.touched.push_back(from);
+    scratch.heap.push(from, 0);
+
+    // Dijkstra, steering clear of the blocked nodes and edges
+    bool found = false;
+    while (!scratch.heap.empty()) {
+        int      current = scratch.heap.pop();
+        Distance dist    = scratch.distance[current];
+
+        scratch.settled += 1;
+        if (current == target) {
+            found = true;
+            break;
+        }
+
+        int last = m_graph->lastArc(current);
+        for (int a = m_graph->firstArc(current); a < last; ++a) {
+            int neighbour = m_graph->arcTarget(a);
+            int weight    = m_graph->arcWeight(a);
+            if (scratch.blockedNode[neighbour] ||
+                    scratch.blockedEdge[m_graph->arcEdge(a)] ||
+                    weight > Unreachable - dist) {
+                continue;
+            }
+
+            Distance newDist = dist + weight;
+            if (newDist >= scratch.distance[neighbour]) {
+                continue;
+            }
+
+            if (scratch.distance[neighbour] == Unreachable) {
+                scratch.touched.push_back(neighbour);
+            }
+            scratch.distance[neighbour]    = newDist;
+            scratch.predecessor[neighbour] = m_graph->arcEdge(a);
+            scratch.heap.push(neighbour, newDist);
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // Walk back from the target to where the search started
+    path.cost = scratch.distance[target];
+    path.edges.clear();
+    for (int v = target; v != from; ) {
+        int e = scratch.predecessor[v];
+        path.edges.push_back(e);
+        v = m_graph->edge(e).source;
+    }
+    std::reverse(path.edges.begin(), path.edges.end());
+
+    return true;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef KSHORTESTPATHS_H
+#define KSHORTESTPATHS_H
+
+#include <vector>
+
+#include "indexedheap.h"
+#include "routinggraph.h"
+#include "threadpool.h"
+
+
+// The K cheapest loopless routes between two nodes, by Yen's algorithm.
+//
+// Each new route is found by deviating from the previous one: for every
+// prefix (the root) of that route, a spur search runs from the node where
+// the prefix ends to the target.  It may not revisit the root's nodes, nor
+// leave by any edge that an accepted route with the same root already used.
+// The spur searches for one route are independent, so they run across a
+// thread pool, each thread with its own search buffers.
+class KShortestPaths
+{
+public:
+    KShortestPaths(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Finds up to k routes, cheapest first; returns how many there are
+    int find(int source, int target, int k, ThreadPool* pool = nullptr);
+    void clear();
+
+    int pathCount() const { return static_cast<int>(m_paths.size()); }
+
+    // Edge indices of route i, ordered start to end, and its cost
+    const std::vector<int>& path(int i) const { return m_paths[i].edges; }
+    Distance cost(int i) const { return m_paths[i].cost; }
+
+    // Nodes settled by every search of the last find()
+    int settledCount() const { return m_settled; }
+
+private:
+    struct Path
+    {
+        Distance            cost;
+        std::vector<int>    edges;
+
+        bool operator<(const Path& other) const;
+    };
+
+    // Search buffers owned by one thread
+    struct Scratch
+    {
+        std::vector<Distance>   distance;
+        std::vector<int>        predecessor;
+        std::vector<int>        touched;
+        IndexedHeap             heap;
+        std::vector<bool>       blockedNode;
+        std::vector<bool>       blockedEdge;
+        std::vector<int>        blockedNodes;
+        std::vector<int>        blockedEdges;
+        int                     settled;
+
+        void resize(int vertexCount, int edgeCount);
+        void unblock();
+    };
+
+    void spur(Scratch& scratch, int source, int target, int root);
+    bool search(Scratch& scratch, int from, int target, Path& path) const;
+
+private:
+    const RoutingGraph*     m_graph;
+    std::vector<Path>       m_paths;
+    std::vector<Scratch>    m_scratch;
+
+    // Outcome of the spur search for each root of the latest route
+    std::vector<Path>       m_spurs;
+    std::vector<char>       m_spurFound;
+    int                     m_settled;
+};
+
+
+#endif  /* !KSHORTESTPATHS_H */
@@ -0,0 +1,192 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include "networkfile.h"
+
+const char NetworkFile::Magic[8] = { 'N', 'E', 'T', 'R', 'O', 'U', 'T', 'E' };
+
+// Sections start on 8-byte boundaries
+static uint64_t padded(uint64_t bytes)
+{
+    return (bytes + 7) & ~static_cast<uint64_t>(7);
+}
+
+// Writes count items and pads the section out to the next boundary
+static bool writeSection(FILE* file, const void* data, size_t size,
+    size_t count)
+{
+    static const char zeros[8] = { 0 };
+
+    uint64_t bytes = static_cast<uint64_t>(size) * count;
+    if (count > 0 && fwrite(data, size, count, file) != count) {
+        return false;
+    }
+
+    size_t padding = static_cast<size_t>(padded(bytes) - bytes);
+    return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+}
+
+
+NetworkFile::NetworkFile()
+    : m_vertexCount(0)
+    , m_edgeCount(0)
+    , m_queryCount(0)
+    , m_nameOffsets(nullptr)
+    , m_names(nullptr)
+    , m_offsets(nullptr)
+    , m_targets(nullptr)
+    , m_weights(nullptr)
+    , m_queries(nullptr)
+{
+}
+
+NetworkFile::Status NetworkFile::read(const char* data, size_t size)
+{
+    if (!isNetworkFile(data, size)) {
+        return BadMagic;
+    }
+    if (size < sizeof(Header)) {
+        return Truncated;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != CurrentVersion) {
+        return BadVersion;
+    }
+    if (header.vertexCount > INT_MAX - 1 || header.edgeCount > INT_MAX ||
+            header.nameBytes > UINT32_MAX || header.queryCount > INT_MAX / 2) {
+        return Corrupt;
+    }
+
+    // Where every section should be, given the counts
+    uint64_t n             = header.vertexCount;
+    uint64_t m             = header.edgeCount;
+    uint64_t nameOffsetsAt = padded(sizeof(Header));
+    uint64_t namesAt       = nameOffsetsAt + padded(4 * (n + 1));
+    uint64_t offsetsAt     = namesAt + padded(header.nameBytes);
+    uint64_t targetsAt     = offsetsAt + padded(4 * (n + 1));
+    uint64_t weightsAt     = targetsAt + padded(4 * m);
+    uint64_t queriesAt     = weightsAt + padded(4 * m);
+    uint64_t end           = queriesAt + padded(8 * header.queryCount);
+    if (end > size) {
+        return Truncated;
+    }
+
+    m_vertexCount = static_cast<int>(n);
+    m_edgeCount   = static_cast<int>(m);
+    m_queryCount  = static_cast<int>(header.queryCount);
+    m_nameOffsets = reinterpret_cast<const uint32_t*>(data + nameOffsetsAt);
+    m_names       = data + namesAt;
+    m_offsets     = reinterpret_cast<const int*>(data + offsetsAt);
+    m_targets     = reinterpret_cast<const int*>(data + targetsAt);
+    m_weights     = reinterpret_cast<const int*>(data + weightsAt);
+    m_queries     = reinterpret_cast<const int*>(data + queriesAt);
+
+    // One pass over everything that indexes something else
+    if (m_nameOffsets[0] != 0 || m_nameOffsets[n] != header.nameBytes ||
+            m_offsets[0] != 0 || m_offsets[n] != m_edgeCount) {
+        return Corrupt;
+    }
+    for (int v = 0; v < m_vertexCount; ++v) {
+        if (m_nameOffsets[v] > m_nameOffsets[v + 1] ||
+                m_offsets[v] > m_offsets[v + 1]) {
+            return Corrupt;
+        }
+    }
+
+    bool valid = true;
+    for (int e = 0; e < m_edgeCount; ++e) {
+        valid &= static_cast<unsigned>(m_targets[e]) <
+            static_cast<unsigned>(m_vertexCount);
+        valid &= m_weights[e] >= 0;
+    }
+    for (int i = 0; i < 2 * m_queryCount; ++i) {
+        valid &= static_cast<unsigned>(m_queries[i]) <
+            static_cast<unsigned>(m_vertexCount);
+    }
+
+    return valid ? Valid : Corrupt;
+}
+
+bool NetworkFile::isNetworkFile(const char* data, size_t size)
+{
+    return size >= sizeof(Magic) && memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+std::string NetworkFile::name(int v) const
+{
+    return std::string(m_names + m_nameOffsets[v],
+        m_nameOffsets[v + 1] - m_nameOffsets[v]);
+}
+
+bool NetworkFile::write(const std::string& fileName,
+    const SymbolTable& names, const std::vector<RoutingEdge>& edges,
+    const std::vector<std::pair<int, int> >& queries)
+{
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = write(file, names, edges, queries);
+    return fclose(file) == 0 && ok;
+}
+
+bool NetworkFile::write(FILE* file, const SymbolTable& names,
+    const std::vector<RoutingEdge>& edges,
+    const std::vector<std::pair<int, int> >& queries)
+{
+    int n = names.size();
+
+    // Gather the sections up front so the header can describe them
+    std::vector<uint32_t> nameOffsets(1, 0);
+    std::string           nameBytes;
+    for (int v = 0; v < n; ++v) {
+        nameBytes += names.name(v);
+        nameOffsets.push_back(static_cast<uint32_t>(nameBytes.size()));
+    }
+
+    std::vector<int> offsets(n + 1, 0);
+    std::vector<int> targets(edges.size());
+    std::vector<int> weights(edges.size());
+    for (size_t e = 0; e < edges.size(); ++e) {
+        offsets[edges[e].source + 1] += 1;
+        targets[e] = edges[e].target;
+        weights[e] = edges[e].weight;
+    }
+    for (int v = 0; v < n; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    std::vector<int> pairs;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        pairs.push_back(queries[i].first);
+        pairs.push_back(queries[i].second);
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version     = CurrentVersion;
+    header.vertexCount = static_cast<uint32_t>(n);
+    header.edgeCount   = edges.size();
+    header.nameBytes   = nameBytes.size();
+    header.queryCount  = static_cast<uint32_t>(queries.size());
+
+    return writeSection(file, &header, sizeof(header), 1) &&
+        writeSection(file, nameOffsets.data(), 4, nameOffsets.size()) &&
+        writeSection(file, nameBytes.data(), 1, nameBytes.size()) &&
+        writeSection(file, offsets.data(), 4, offsets.size()) &&
+        writeSection(file, targets.data(), 4, targets.size()) &&
+        writeSection(file, weights.data(), 4, weights.size()) &&
+        writeSection(file, pairs.data(), 4, pairs.size());
+}
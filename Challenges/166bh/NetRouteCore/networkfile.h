@@ -0,0 +1,111 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef NETWORKFILE_H
+#define NETWORKFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "routinggraph.h"
+#include "symboltable.h"
+
+
+// Binary network format for large, sparse networks, laid out so that a
+// memory-mapped file can be handed to RoutingGraph without parsing.
+//
+// Everything is little-endian and each section starts on an 8-byte boundary:
+//
+//     Header
+//     uint32  nameOffsets[vertexCount + 1]     into the name bytes
+//     char    names[nameBytes]                 UTF-8, not terminated
+//     int32   offsets[vertexCount + 1]         CSR row starts
+//     int32   targets[edgeCount]
+//     int32   weights[edgeCount]
+//     int32   queries[2 * queryCount]          start/end node pairs
+//
+// Edges are numbered in CSR order, which for a converted specification is
+// the row-major order the explorer has always used.  read() checks every
+// offset and node index once, so the accessors can be trusted afterwards.
+class NetworkFile
+{
+public:
+    enum Status {
+        Valid,
+        BadMagic,
+        BadVersion,
+        Truncated,
+        Corrupt,
+    };
+
+    struct Header
+    {
+        char        magic[8];
+        uint32_t    version;
+        uint32_t    vertexCount;
+        uint64_t    edgeCount;
+        uint64_t    nameBytes;
+        uint32_t    queryCount;
+        uint32_t    reserved;
+    };
+
+    static const uint32_t CurrentVersion = 1;
+
+    NetworkFile();
+
+    // Points the reader at a file image; nothing is copied, so the image
+    // must outlive every use of the accessors
+    Status read(const char* data, size_t size);
+
+    // Cheap check of the magic number, for telling formats apart
+    static bool isNetworkFile(const char* data, size_t size);
+
+    int vertexCount() const { return m_vertexCount; }
+    int edgeCount() const { return m_edgeCount; }
+    int queryCount() const { return m_queryCount; }
+
+    std::string name(int v) const;
+
+    const int* offsets() const { return m_offsets; }
+    const int* targets() const { return m_targets; }
+    const int* weights() const { return m_weights; }
+
+    int querySource(int i) const { return m_queries[2 * i]; }
+    int queryTarget(int i) const { return m_queries[2 * i + 1]; }
+
+    // Writes a network out in this format.  The edges must already be
+    // sorted by source, as a SpecParser leaves them.
+    static bool write(const std::string& fileName, const SymbolTable& names,
+        const std::vector<RoutingEdge>& edges,
+        const std::vector<std::pair<int, int> >& queries);
+
+    // As above, at the current position of a file that is already open, so
+    // that a network can be embedded in a larger file
+    static bool write(FILE* file, const SymbolTable& names,
+        const std::vector<RoutingEdge>& edges,
+        const std::vector<std::pair<int, int> >& queries);
+
+private:
+    static const char Magic[8];
+
+    int                 m_vertexCount;
+    int                 m_edgeCount;
+    int                 m_queryCount;
+
+    const uint32_t*     m_nameOffsets;
+    const char*         m_names;
+    const int*          m_offsets;
+    const int*          m_targets;
+    const int*          m_weights;
+    const int*          m_queries;
+};
+
+
+#endif  /* !NETWORKFILE_H */
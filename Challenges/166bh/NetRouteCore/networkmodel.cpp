@@ -0,0 +1,671 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+#include "networkmodel.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Fraction of the matrix cells holding a link above which plain Dijkstra
+// runs over the matrix instead of a heap
+static const double DenseThreshold = 0.25;
+
+// printf() into a string, for the transcript
+static std::string format(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int length = vsnprintf(nullptr, 0, fmt, args);
+    va_end(args);
+
+    std::vector<char> text(length + 1);
+    va_start(args, fmt);
+    vsnprintf(text.data(), text.size(), fmt, args);
+    va_end(args);
+
+    return std::string(text.data(), length);
+}
+
+static int64_t nanosecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start).count();
+}
+
+// StageResult implementation
+void NetworkModel::StageResult::clear()
+{
+    result      = Success;
+    nanoseconds = 0;
+    messages.clear();
+}
+
+void NetworkModel::StageResult::post(MessageType type,
+    const std::string& text)
+{
+    messages.push_back(Message(type, text));
+}
+
+// NetworkModel implementation
+NetworkModel::NetworkModel()
+    : m_progress(nullptr)
+    , m_routeDistance(Unreachable)
+    , m_settled(0)
+    , m_usedDense(false)
+{
+}
+
+int NetworkModel::check(const SpecParser& spec, StageResult& stage)
+{
+    if (spec.status() == SpecParser::Empty) {
+        stage.post(ErrorMessage, "Problem specification is empty after "
+            "whitespace removed!");
+        return stage.result = ErrorEmpty;
+    }
+
+    // Validate the length of the specification; the node count may be
+    // followed by the names of the nodes on the same line
+    int nodeCount = spec.nodeCount();
+    stage.post(InfoMessage, format("Expecting %dx%d adjacency matrix...",
+        nodeCount, nodeCount));
+
+    switch (spec.status()) {
+    case SpecParser::TooFewLines:
+        stage.post(ErrorMessage, format("Expecting at least %lld lines in "
+            "specification; read %d", nodeCount + 2LL, spec.lineCount()));
+        return stage.result = ErrorSpecTooSmall;
+
+    case SpecParser::BadNodeNames:
+        stage.post(ErrorMessage, format("Expecting %d node names; read %d",
+            nodeCount, spec.nameCount()));
+        return stage.result = ErrorBadNodeNames;
+
+    case SpecParser::DuplicateName:
+        stage.post(ErrorMessage, format("Node name '%s' is used more than "
+            "once.", spec.duplicateName().c_str()));
+        return stage.result = ErrorBadNodeNames;
+
+    case SpecParser::ShortRow:
+        // The rows before it were fine, so their cells are reported first
+        for (size_t i = 0; i < spec.badCells().size(); ++i) {
+            const SpecParser::BadCell& cell = spec.badCells()[i];
+            stage.post(WarningMessage, format("Weight (%d,%d) is malformed: "
+                "%s.", cell.row, cell.column, cell.text.c_str()));
+        }
+        stage.post(ErrorMessage, format("Matrix row %d has %d columns; "
+            "expecting %d.", spec.shortRow(), spec.shortRowLength(),
+            nodeCount));
+        return stage.result = ErrorRowTooShort;
+
+    default:
+        break;
+    }
+
+    return Success;
+}
+
+int NetworkModel::check(const NetworkFile& network, StageResult& stage)
+{
+    int nodeCount = network.vertexCount();
+
+    stage.post(InfoMessage, format("Reading %d nodes and %d links from "
+        "binary network...", nodeCount, network.edgeCount()));
+
+    SymbolTable names;
+    names.reserve(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+        std::string name = network.name(i);
+        if (names.intern(name) != i) {
+            stage.post(ErrorMessage, format("Node name '%s' is used more "
+                "than once.", name.c_str()));
+            return stage.result = ErrorBadNodeNames;
+        }
+    }
+
+    return Success;
+}
+
+int NetworkModel::load(SpecParser& spec)
+{
+    Clock::time_point start = Clock::now();
+
+    clear();
+    m_loadResult.clear();
+
+    int result = check(spec, m_loadResult);
+    if (result < 0) {
+        return result;
+    }
+
+    // Build the compact routing representation
+    m_names = std::move(spec.names());
+    m_graph.build(spec.nodeCount(), spec.edges());
+    attachEngines();
+
+    for (size_t i = 0; i < spec.badCells().size(); ++i) {
+        const SpecParser::BadCell& cell = spec.badCells()[i];
+        m_loadResult.post(WarningMessage, format("Weight (%d,%d) is "
+            "malformed: %s.", cell.row, cell.column, cell.text.c_str()));
+        result |= WarningBadCell;
+    }
+
+    // The remaining lines of the description are start/end pairs, the
+    // first of which is the route shown in the explorer
+    for (size_t i = 0; i < spec.queryLines().size(); ++i) {
+        RouteQuery query;
+
+        int queryResult = parseRouteQuery(spec.queryLines()[i], m_names,
+            query, m_loadResult);
+        if (queryResult == Success) {
+            m_queries.push_back(query);
+        }
+        result |= queryResult;
+    }
+
+    m_loadResult.result      = result;
+    m_loadResult.nanoseconds = nanosecondsSince(start);
+    return result;
+}
+
+int NetworkModel::load(const NetworkFile& network)
+{
+    Clock::time_point start = Clock::now();
+
+    clear();
+    m_loadResult.clear();
+
+    int result = check(network, m_loadResult);
+    if (result < 0) {
+        return result;
+    }
+
+    int nodeCount = network.vertexCount();
+    m_names.reserve(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+        m_names.intern(network.name(i));
+    }
+
+    // The arrays are already in CSR order, so there are no edges to gather
+    m_graph.build(nodeCount, network.offsets(), network.targets(),
+        network.weights());
+    attachEngines();
+
+    for (int i = 0; i < network.queryCount(); ++i) {
+        m_queries.push_back(
+            RouteQuery(network.querySource(i), network.queryTarget(i)));
+    }
+    if (m_queries.empty()) {
+        m_loadResult.post(WarningMessage, "Network file has no start and "
+            "end nodes; routing will not take place.");
+        result |= WarningBadStartEnd;
+    }
+
+    m_loadResult.result      = result;
+    m_loadResult.nanoseconds = nanosecondsSince(start);
+    return result;
+}
+
+int NetworkModel::load(const char* data, size_t size,
+    ThreadPool* pool /* = nullptr */)
+{
+    if (NetworkFile::isNetworkFile(data, size)) {
+        NetworkFile network;
+
+        NetworkFile::Status status = network.read(data, size);
+        if (status != NetworkFile::Valid) {
+            clear();
+            m_loadResult.clear();
+            m_loadResult.post(ErrorMessage, format("Not a usable network "
+                "file: %s.",
+                status == NetworkFile::BadVersion ? "unknown version" :
+                status == NetworkFile::Truncated  ? "file is truncated" :
+                                                    "file is corrupt"));
+            return m_loadResult.result = ErrorBadFile;
+        }
+
+        return load(network);
+    }
+
+    SpecParser spec;
+    spec.parse(data, size, pool);
+    return load(spec);
+}
+
+void NetworkModel::clear()
+{
+    m_router.setGraph(nullptr);
+    m_denseRouter.setGraph(nullptr);
+    m_denseRouter.clear();
+    m_bidirectionalRouter.setGraph(nullptr);
+    m_altRouter.setGraph(nullptr);
+    m_chRouter.clear();
+    m_deltaRouter.setGraph(nullptr);
+    m_kShortestPaths.setGraph(nullptr);
+    m_batchRouter.setGraph(nullptr);
+    m_layout.clear();
+
+    m_names.clear();
+    m_graph.clear();
+    m_queries.clear();
+
+    m_routeDistance = Unreachable;
+    m_routePath.clear();
+    m_settled       = 0;
+    m_usedDense     = false;
+}
+
+int NetworkModel::parseRouteQuery(const std::string& line,
+    const SymbolTable& names, RouteQuery& query, StageResult& stage)
+{
+    int result = Success;
+
+    // Split on whitespace, as QString::split() with \s+ would
+    std::vector<std::string> nodes;
+    for (size_t i = 0; i < line.size(); ) {
+        if (isspace(static_cast<unsigned char>(line[i]))) {
+            ++i;
+            continue;
+        }
+
+        size_t end = i;
+        while (end < line.size() &&
+                !isspace(static_cast<unsigned char>(line[end]))) {
+            ++end;
+        }
+        nodes.push_back(line.substr(i, end - i));
+        i = end;
+    }
+
+    if (nodes.size() != 2) {
+        size_t first = 0;
+        size_t last  = line.size();
+        while (first < last &&
+                isspace(static_cast<unsigned char>(line[first]))) {
+            ++first;
+        }
+        while (last > first &&
+                isspace(static_cast<unsigned char>(line[last - 1]))) {
+            --last;
+        }
+        std::string trimmed = line.substr(first, last - first);
+
+        stage.post(WarningMessage, format("Start and end nodes line '%s' is "
+            "malformed; routing will not take place.", trimmed.c_str()));
+        return WarningBadStartEnd;
+    }
+
+    // Nodes may be given by name or by their numeric index
+    query.source = names.resolve(nodes[0]);
+    query.target = names.resolve(nodes[1]);
+
+    if (query.source < 0) {
+        stage.post(WarningMessage, format("Failed to find start node '%s'; "
+            "routing will not take place.", nodes[0].c_str()));
+        result |= WarningNoStartNode;
+    }
+
+    if (query.target < 0) {
+        stage.post(WarningMessage, format("Failed to find end node '%s'; "
+            "routing will not take place.", nodes[1].c_str()));
+        result |= WarningNoEndNode;
+    }
+
+    return result;
+}
+
+std::string NetworkModel::routeText(const RoutingGraph& graph,
+    const SymbolTable& names, int source, const std::vector<int>& path)
+{
+    const char* separator = names.longestName() > 1 ? " -> " : "";
+
+    std::string route = names.name(source);
+    for (size_t e = 0; e < path.size(); ++e) {
+        route += separator;
+        route += names.name(graph.edge(path[e]).target);
+    }
+
+    return route;
+}
+
+double NetworkModel::density() const
+{
+    double n = m_graph.vertexCount();
+    return n > 0 ? m_graph.edgeCount() / (n * n) : 0.0;
+}
+
+void NetworkModel::swapQueries(std::vector<RouteQuery>& queries)
+{
+    m_queries.swap(queries);
+}
+
+void NetworkModel::setEdgeWeight(int e, int weight)
+{
+    m_graph.setEdgeWeight(e, weight);
+    edited(e);
+}
+
+int NetworkModel::addEdge(int source, int target, int weight)
+{
+    int e = m_graph.addEdge(source, target, weight);
+    m_layout.addEdge(e);
+    edited(e);
+    return e;
+}
+
+void NetworkModel::removeEdge(int e)
+{
+    // Its index is not reused
+    m_graph.removeEdge(e);
+    m_layout.removeEdge(e);
+    edited(e);
+}
+
+bool NetworkModel::route(int source, int target, const RouteOptions& options,
+    ThreadPool* pool /* = nullptr */)
+{
+    RoutingAlgorithm algorithm = options.algorithm;
+    double           density   = this->density();
+    bool             found;
+
+    m_routeResult.clear();
+    m_routePath.clear();
+    m_routeDistance = Unreachable;
+    m_kShortestPaths.clear();
+
+    // Mostly-full matrices are quicker to scan than to push through a heap
+    m_usedDense = (algorithm == DijkstraRouting ||
+                   algorithm == BoostRouting) &&
+        density >= DenseThreshold && m_denseRouter.vertexCount() > 0;
+
+    // Preprocessing is reported separately, so it restarts the clock
+    Clock::time_point start = Clock::now();
+    switch (algorithm) {
+    case BidirectionalRouting:
+        // Meet in the middle: forwards from the start, backwards from the end
+        found     = m_bidirectionalRouter.route(source, target);
+        m_settled = m_bidirectionalRouter.settledCount();
+        if (found) {
+            m_routeDistance = m_bidirectionalRouter.distance();
+            m_routePath     = m_bidirectionalRouter.path();
+        }
+        break;
+
+    case AltRouting:
+        // Landmarks only need to be picked once per graph
+        if (m_altRouter.landmarkCount() !=
+                std::min(options.landmarkCount, m_graph.vertexCount())) {
+            if (!m_altRouter.preprocess(options.landmarkCount, m_progress)) {
+                found = false;
+                break;
+            }
+            m_routeResult.post(InfoMessage, format("Selected %d landmarks in "
+                "%lld ms.", m_altRouter.landmarkCount(),
+                static_cast<long long>(nanosecondsSince(start) / 1000000)));
+            start = Clock::now();
+        }
+        if (cancelled()) {
+            found = false;
+            break;
+        }
+
+        // A* guided by the landmark lower bounds
+        found     = m_altRouter.route(source, target);
+        m_settled = m_altRouter.settledCount();
+        if (found) {
+            m_routeDistance = m_altRouter.distance(target);
+            m_routePath     = m_altRouter.path(target);
+        }
+        break;
+
+    case ChRouting:
+        // The hierarchy is built once per graph, on the first query
+        if (!m_chRouter.isBuilt()) {
+            m_routeResult.post(InfoMessage, "Contracting nodes...");
+            if (!m_chRouter.build(m_graph, m_progress)) {
+                found = false;
+                break;
+            }
+            m_routeResult.post(InfoMessage, format("Contracted %d nodes in "
+                "%lld ms, adding %d shortcuts.", m_graph.vertexCount(),
+                static_cast<long long>(nanosecondsSince(start) / 1000000),
+                m_chRouter.shortcutCount()));
+            start = Clock::now();
+        }
+        if (cancelled()) {
+            found = false;
+            break;
+        }
+
+        // Bidirectional search up the hierarchy; shortcuts are unpacked
+        found     = m_chRouter.route(source, target);
+        m_settled = m_chRouter.settledCount();
+        if (found) {
+            m_routeDistance = m_chRouter.distance();
+            m_routePath     = m_chRouter.path();
+        }
+        break;
+
+    case YenRouting:
+        // The cheapest of Yen's routes is the one drawn
+        found = m_kShortestPaths.find(source, target, options.pathCount,
+            pool) > 0;
+        m_settled = m_kShortestPaths.settledCount();
+        if (found) {
+            m_routeDistance = m_kShortestPaths.cost(0);
+            m_routePath     = m_kShortestPaths.path(0);
+        }
+        break;
+
+    case DeltaSteppingRouting:
+        // Whole buckets of nodes are relaxed at once across the thread pool
+        m_deltaRouter.setDelta(options.bucketWidth);
+        found     = m_deltaRouter.route(source, target, pool);
+        m_settled = m_deltaRouter.settledCount();
+        if (found) {
+            m_routeDistance = m_deltaRouter.distance(target);
+            m_routePath     = m_deltaRouter.path(target);
+        }
+        break;
+
+    case BoostRouting:
+        // Boost.Graph routes over the explorer's own graph, which the model
+        // does not have; the explorer compares it against this
+    case DijkstraRouting:
+    default:
+        if (m_usedDense) {
+            found     = m_denseRouter.route(source, target);
+            m_settled = m_denseRouter.settledCount();
+            if (found) {
+                m_routeDistance = m_denseRouter.distance(target);
+                m_routePath     = m_denseRouter.path(target);
+            }
+            break;
+        }
+
+        // Dijkstra's algorithm: settle nodes until the target is reached
+        found     = m_router.route(source, target);
+        m_settled = m_router.settledCount();
+        if (found) {
+            m_routeDistance = m_router.distance(target);
+            m_routePath     = m_router.path(target);
+        }
+        break;
+    }
+
+    m_routeResult.nanoseconds = nanosecondsSince(start);
+
+    if (cancelled()) {
+        m_routeResult.post(WarningMessage, "Routing cancelled.");
+        m_routeResult.result = ErrorCancelled;
+        return false;
+    }
+
+    if (m_usedDense) {
+        m_routeResult.post(InfoMessage, format("Network is %.1f%% dense; "
+            "searched the adjacency matrix directly.", 100.0 * density));
+    } else if (algorithm == DeltaSteppingRouting) {
+        m_routeResult.post(InfoMessage, format("Emptied %d buckets of width "
+            "%d on %d threads.", m_deltaRouter.bucketCount(),
+            m_deltaRouter.usedDelta(), pool ? pool->threadCount() : 1));
+    }
+
+    if (!found) {
+        m_routeResult.post(WarningMessage, format("Node %s cannot be reached "
+            "from node %s.", m_names.name(target).c_str(),
+            m_names.name(source).c_str()));
+        m_routeResult.result = WarningUnreachable;
+    } else {
+        m_routeResult.post(InfoMessage, format("Search complete; reached "
+            "target node after settling %d of %d nodes in %.1f us!",
+            m_settled, m_graph.vertexCount(),
+            m_routeResult.nanoseconds / 1000.0));
+    }
+
+    return found;
+}
+
+void NetworkModel::routeBatch(ThreadPool* pool /* = nullptr */)
+{
+    int threads = pool ? pool->threadCount() : 1;
+
+    m_batchResult.clear();
+    m_batchResult.post(InfoMessage, format("Routing %d queries on %d "
+        "threads...", static_cast<int>(m_queries.size()), threads));
+
+    Clock::time_point start = Clock::now();
+    m_batchRouter.route(m_queries, pool);
+    m_batchResult.nanoseconds = nanosecondsSince(start);
+
+    m_batchResult.post(InfoMessage, format("Routed %d queries in %.2f ms "
+        "(%.0f queries/s).", m_batchRouter.queryCount(),
+        m_batchResult.nanoseconds / 1e6,
+        m_batchRouter.queryCount() * 1e9 /
+            std::max<int64_t>(m_batchResult.nanoseconds, 1)));
+}
+
+void NetworkModel::randomLayout(double left, double top, double right,
+    double bottom, unsigned seed)
+{
+    Clock::time_point start = Clock::now();
+
+    m_layoutResult.clear();
+    m_layout.randomLayout(left, top, right, bottom, seed);
+    m_layoutResult.nanoseconds = nanosecondsSince(start);
+}
+
+void NetworkModel::springLayout(double left, double top, double right,
+    double bottom, int maxIterations, double tolerance, unsigned seed)
+{
+    Clock::time_point start = Clock::now();
+
+    m_layoutResult.clear();
+    bool finished = m_layout.springLayout(left, top, right, bottom,
+        maxIterations, tolerance, seed, m_progress);
+    layoutFinished(finished, nanosecondsSince(start));
+}
+
+void NetworkModel::forceLayout(double left, double top, double right,
+    double bottom, int maxIterations, double tolerance, unsigned seed,
+    ThreadPool* pool /* = nullptr */)
+{
+    Clock::time_point start = Clock::now();
+
+    m_layoutResult.clear();
+    bool finished = m_layout.forceLayout(left, top, right, bottom,
+        maxIterations, tolerance, seed, m_progress, pool);
+    layoutFinished(finished, nanosecondsSince(start));
+}
+
+void NetworkModel::multilevelLayout(double left, double top, double right,
+    double bottom, int maxIterations, double tolerance, unsigned seed,
+    ThreadPool* pool /* = nullptr */)
+{
+    Clock::time_point start = Clock::now();
+
+    m_layoutResult.clear();
+    bool finished = m_layout.multilevelLayout(left, top, right, bottom,
+        maxIterations, tolerance, seed, m_progress, pool);
+
+    // Coarsest first, as they were laid out
+    const std::vector<GraphLayout::LevelReport>& levels = m_layout.levels();
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const GraphLayout::LevelReport& level = levels[i];
+        m_layoutResult.post(InfoMessage, format("Level %d: %d nodes and %d "
+            "links, %d iterations in %.1f ms; links %.2f +/- %.2f times "
+            "the ideal length.",
+            static_cast<int>(levels.size() - 1 - i), level.vertexCount,
+            level.edgeCount, level.iterations, level.nanoseconds / 1e6,
+            level.meanLinkLength, level.linkLengthSpread));
+    }
+
+    layoutFinished(finished, nanosecondsSince(start));
+}
+
+void NetworkModel::layoutFinished(bool finished, int64_t nanoseconds)
+{
+    m_layoutResult.nanoseconds = nanoseconds;
+
+    if (!finished) {
+        m_layoutResult.post(WarningMessage, format("Layout stopped after "
+            "%lld ms; keeping the positions reached.",
+            static_cast<long long>(m_layoutResult.nanoseconds / 1000000)));
+        m_layoutResult.result = ErrorCancelled;
+        return;
+    }
+
+    m_layoutResult.post(InfoMessage, format("Laid out %d nodes in %lld ms.",
+        m_graph.vertexCount(),
+        static_cast<long long>(m_layoutResult.nanoseconds / 1000000)));
+}
+
+void NetworkModel::attachEngines()
+{
+    int nodeCount = m_graph.vertexCount();
+
+    // Only networks dense enough to be routed over the matrix get one; a
+    // large sparse network could never hold it
+    bool dense = density() >= DenseThreshold;
+    m_denseRouter.resize(dense ? nodeCount : 0);
+    for (int e = 0; dense && e < m_graph.edgeCount(); ++e) {
+        const RoutingEdge& link = m_graph.edge(e);
+        m_denseRouter.setWeight(link.source, link.target, link.weight);
+    }
+
+    m_router.setGraph(&m_graph);
+    m_denseRouter.setGraph(&m_graph);
+    m_bidirectionalRouter.setGraph(&m_graph);
+    m_altRouter.setGraph(&m_graph);
+    m_chRouter.clear();
+    m_deltaRouter.setGraph(&m_graph);
+    m_kShortestPaths.setGraph(&m_graph);
+    m_batchRouter.setGraph(&m_graph);
+    m_layout.setGraph(&m_graph);
+}
+
+bool NetworkModel::cancelled() const
+{
+    return m_progress && m_progress->isCancelled();
+}
+
+void NetworkModel::edited(int e)
+{
+    // Anything precomputed from the old weights is now stale
+    m_kShortestPaths.clear();
+    if (m_denseRouter.vertexCount() > 0) {
+        m_denseRouter.updateWeight(m_graph.edge(e).source,
+            m_graph.edge(e).target);
+    }
+    m_altRouter.setGraph(&m_graph);
+    m_deltaRouter.weightsChanged();
+    m_chRouter.clear();
+    m_batchRouter.clear();
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef NETWORKMODEL_H
+#define NETWORKMODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "altengine.h"
+#include "batchrouter.h"
+#include "bidirectionalengine.h"
+#include "contractionhierarchy.h"
+#include "deltasteppingengine.h"
+#include "densedijkstraengine.h"
+#include "dijkstraengine.h"
+#include "graphlayout.h"
+#include "jobprogress.h"
+#include "kshortestpaths.h"
+#include "networkfile.h"
+#include "routinggraph.h"
+#include "specparser.h"
+#include "symboltable.h"
+#include "threadpool.h"
+
+
+// Everything the explorer does to a network short of drawing it: loading a
+// specification or binary network, routing over it with any of the engines,
+// and laying its nodes out.  Each stage leaves a StageResult behind with its
+// outcome, how long it took and the transcript the explorer would write, so
+// that callers can report it however suits them.
+//
+// The engines keep pointers into the model, so it is neither copied nor
+// moved once something has been loaded.
+class NetworkModel
+{
+public:
+    // Stage outcomes: negative for errors, otherwise a set of warning flags
+    enum Result {
+        Success             =  0,
+
+        ErrorEmpty          = -1,
+        ErrorSpecTooSmall   = -2,
+        ErrorRowTooShort    = -3,
+        ErrorBadNodeNames   = -4,
+        ErrorBadFile        = -5,
+        ErrorCancelled      = -6,
+
+        WarningBadCell      = 0x02,
+        WarningBadStartEnd  = 0x04,
+        WarningNoStartNode  = 0x08,
+        WarningNoEndNode    = 0x10,
+        WarningUnreachable  = 0x20,
+    };
+
+    enum MessageType {
+        InfoMessage,
+        SuccessMessage,
+        WarningMessage,
+        ErrorMessage,
+    };
+
+    struct Message
+    {
+        MessageType     type;
+        std::string     text;
+
+        Message(MessageType type_ = InfoMessage,
+                const std::string& text_ = std::string())
+            : type(type_)
+            , text(text_)
+        {
+        }
+    };
+
+    struct StageResult
+    {
+        int                     result;
+        int64_t                 nanoseconds;
+        std::vector<Message>    messages;
+
+        StageResult() : result(Success), nanoseconds(0) {}
+
+        void clear();
+        void post(MessageType type, const std::string& text);
+    };
+
+    // Settings for the engines that take any
+    struct RouteOptions
+    {
+        RoutingAlgorithm    algorithm;
+        int                 landmarkCount;
+        int                 pathCount;
+        int                 bucketWidth;
+
+        RouteOptions()
+            : algorithm(DijkstraRouting)
+            , landmarkCount(8)
+            , pathCount(3)
+            , bucketWidth(0)
+        {
+        }
+    };
+
+    NetworkModel();
+
+    // Long-running stages advance this, if set, and stop early once it is
+    // cancelled; see route() and the layouts
+    JobProgress* progress() const { return m_progress; }
+    void setProgress(JobProgress* progress) { m_progress = progress; }
+
+    // Loading.  check() validates without touching the model, so that a
+    // caller can decide whether to give up the network it already has; the
+    // load() functions replace the network, which is left empty on an error.
+    static int check(const SpecParser& spec, StageResult& stage);
+    static int check(const NetworkFile& network, StageResult& stage);
+    int load(SpecParser& spec);
+    int load(const NetworkFile& network);
+    int load(const char* data, size_t size, ThreadPool* pool = nullptr);
+    void clear();
+
+    const StageResult& loadResult() const { return m_loadResult; }
+
+    // A start/end line, by name or index, as written in a specification
+    static int parseRouteQuery(const std::string& line,
+        const SymbolTable& names, RouteQuery& query, StageResult& stage);
+
+    // A route as the names of its nodes in order.  They are run together,
+    // as in the original reports, only while every name is one character;
+    // otherwise " -> " separates the hops so that the names cannot merge.
+    static std::string routeText(const RoutingGraph& graph,
+        const SymbolTable& names, int source, const std::vector<int>& path);
+
+    const SymbolTable& names() const { return m_names; }
+    const RoutingGraph& graph() const { return m_graph; }
+    bool isEmpty() const { return m_graph.vertexCount() == 0; }
+    double density() const;
+
+    // Every start/end line; the first is the one the explorer draws
+    const std::vector<RouteQuery>& queries() const { return m_queries; }
+    void swapQueries(std::vector<RouteQuery>& queries);
+
+    // Editing.  Whatever the engines precomputed from the old weights is
+    // thrown away, including any alternatives and batch results.
+    void setEdgeWeight(int e, int weight);
+    int  addEdge(int source, int target, int weight);
+    void removeEdge(int e);
+
+    // Routing.  Preprocessing is reported as it happens and is not counted
+    // in the query time.  A cancellation is noticed once preprocessing is
+    // done, and leaves ErrorCancelled as the result.
+    bool route(int source, int target, const RouteOptions& options,
+        ThreadPool* pool = nullptr);
+
+    const StageResult& routeResult() const { return m_routeResult; }
+    Distance routeDistance() const { return m_routeDistance; }
+    const std::vector<int>& routePath() const { return m_routePath; }
+    int settledCount() const { return m_settled; }
+    bool usedDenseMatrix() const { return m_usedDense; }
+
+    // Yen's routes from the last YenRouting query, cheapest first
+    const KShortestPaths& alternatives() const { return m_kShortestPaths; }
+    void clearAlternatives() { m_kShortestPaths.clear(); }
+
+    // Every query at once, across the pool
+    void routeBatch(ThreadPool* pool = nullptr);
+    const StageResult& batchResult() const { return m_batchResult; }
+    const BatchRouter& batch() const { return m_batchRouter; }
+    void clearBatch() { m_batchRouter.clear(); }
+
+    // Layout, into the box given; see GraphLayout.  A cancelled layout
+    // keeps the positions it had reached.  The multilevel layout reports
+    // the time and link lengths of each level as it refines.
+    void randomLayout(double left, double top, double right, double bottom,
+        unsigned seed);
+    void springLayout(double left, double top, double right, double bottom,
+        int maxIterations, double tolerance, unsigned seed);
+    void forceLayout(double left, double top, double right, double bottom,
+        int maxIterations, double tolerance, unsigned seed,
+        ThreadPool* pool = nullptr);
+    void multilevelLayout(double left, double top, double right,
+        double bottom, int maxIterations, double tolerance, unsigned seed,
+        ThreadPool* pool = nullptr);
+
+    const StageResult& layoutResult() const { return m_layoutResult; }
+    const GraphLayout& layout() const { return m_layout; }
+
+private:
+    void attachEngines();
+    void edited(int e);
+    bool cancelled() const;
+    void layoutFinished(bool finished, int64_t nanoseconds);
+
+private:
+    SymbolTable             m_names;
+    RoutingGraph            m_graph;
+    std::vector<RouteQuery> m_queries;
+
+    DijkstraEngine          m_router;
+    DenseDijkstraEngine     m_denseRouter;
+    BidirectionalEngine     m_bidirectionalRouter;
+    AltEngine               m_altRouter;
+    ContractionHierarchy    m_chRouter;
+    DeltaSteppingEngine     m_deltaRouter;
+    KShortestPaths          m_kShortestPaths;
+    BatchRouter             m_batchRouter;
+    GraphLayout             m_layout;
+    JobProgress*            m_progress;
+
+    Distance                m_routeDistance;
+    std::vector<int>        m_routePath;
+    int                     m_settled;
+    bool                    m_usedDense;
+
+    StageResult             m_loadResult;
+    StageResult             m_routeResult;
+    StageResult             m_batchResult;
+    StageResult             m_layoutResult;
+};
+
+
+#endif  /* !NETWORKMODEL_H */
@@ -0,0 +1,189 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include "routinggraph.h"
+
+// Spare arcs given to each row whenever the arrays are laid out
+static int rowSlack(int degree)
+{
+    return 1 + degree / 8;
+}
+
+RoutingGraph::RoutingGraph()
+    : m_vertexCount(0)
+    , m_offsets(1, 0)
+    , m_inOffsets(1, 0)
+{
+}
+
+void RoutingGraph::build(int vertexCount, const std::vector<RoutingEdge>& edges)
+{
+    m_vertexCount = vertexCount;
+    m_edges       = edges;
+
+    // Every edge starts out present
+    m_arcOf.assign(edges.size(), 0);
+    m_inArcOf.assign(edges.size(), 0);
+
+    layout();
+}
+
+void RoutingGraph::build(int vertexCount, const int* offsets,
+    const int* targets, const int* weights)
+{
+    int edgeCount = offsets[vertexCount];
+
+    m_vertexCount = vertexCount;
+    m_edges.resize(edgeCount);
+    for (int v = 0; v < vertexCount; ++v) {
+        for (int a = offsets[v]; a < offsets[v + 1]; ++a) {
+            m_edges[a] = RoutingEdge(v, targets[a], weights[a]);
+        }
+    }
+
+    // Every edge starts out present
+    m_arcOf.assign(edgeCount, 0);
+    m_inArcOf.assign(edgeCount, 0);
+
+    layout();
+}
+
+void RoutingGraph::clear()
+{
+    m_vertexCount = 0;
+    m_edges.clear();
+    m_offsets.assign(1, 0);
+    m_ends.clear();
+    m_targets.clear();
+    m_weights.clear();
+    m_edgeIds.clear();
+    m_inOffsets.assign(1, 0);
+    m_inEnds.clear();
+    m_inSources.clear();
+    m_inWeights.clear();
+    m_inEdgeIds.clear();
+    m_arcOf.clear();
+    m_inArcOf.clear();
+}
+
+void RoutingGraph::setEdgeWeight(int e, int weight)
+{
+    m_edges[e].weight = weight;
+    if (hasEdge(e)) {
+        m_weights[m_arcOf[e]]     = weight;
+        m_inWeights[m_inArcOf[e]] = weight;
+    }
+}
+
+int RoutingGraph::addEdge(int source, int target, int weight)
+{
+    int e = static_cast<int>(m_edges.size());
+
+    m_edges.push_back(RoutingEdge(source, target, weight));
+    m_arcOf.push_back(0);
+    m_inArcOf.push_back(0);
+
+    // Start again with fresh slack if either row is full
+    if (m_ends[source] == m_offsets[source + 1] ||
+            m_inEnds[target] == m_inOffsets[target + 1]) {
+        layout();
+        return e;
+    }
+
+    int a = m_ends[source]++;
+    m_targets[a] = target;
+    m_weights[a] = weight;
+    m_edgeIds[a] = e;
+    m_arcOf[e]   = a;
+
+    int b = m_inEnds[target]++;
+    m_inSources[b] = source;
+    m_inWeights[b] = weight;
+    m_inEdgeIds[b] = e;
+    m_inArcOf[e]   = b;
+
+    return e;
+}
+
+void RoutingGraph::removeEdge(int e)
+{
+    if (!hasEdge(e)) {
+        return;
+    }
+
+    // Fill the hole with the last arc of the row
+    int a    = m_arcOf[e];
+    int last = --m_ends[m_edges[e].source];
+    m_targets[a] = m_targets[last];
+    m_weights[a] = m_weights[last];
+    m_edgeIds[a] = m_edgeIds[last];
+    m_arcOf[m_edgeIds[a]] = a;
+
+    int b      = m_inArcOf[e];
+    int inLast = --m_inEnds[m_edges[e].target];
+    m_inSources[b] = m_inSources[inLast];
+    m_inWeights[b] = m_inWeights[inLast];
+    m_inEdgeIds[b] = m_inEdgeIds[inLast];
+    m_inArcOf[m_inEdgeIds[b]] = b;
+
+    m_arcOf[e]   = -1;
+    m_inArcOf[e] = -1;
+}
+
+void RoutingGraph::layout()
+{
+    int vertexCount = m_vertexCount;
+
+    // Count the degrees of every vertex and turn them into row offsets,
+    // leaving a little room at the end of each row
+    std::vector<int> degree(vertexCount, 0);
+    std::vector<int> inDegree(vertexCount, 0);
+    for (size_t e = 0; e < m_edges.size(); ++e) {
+        if (hasEdge(static_cast<int>(e))) {
+            degree[m_edges[e].source] += 1;
+            inDegree[m_edges[e].target] += 1;
+        }
+    }
+
+    m_offsets.assign(vertexCount + 1, 0);
+    m_inOffsets.assign(vertexCount + 1, 0);
+    for (int v = 0; v < vertexCount; ++v) {
+        m_offsets[v + 1]   = m_offsets[v] + degree[v] + rowSlack(degree[v]);
+        m_inOffsets[v + 1] = m_inOffsets[v] + inDegree[v] +
+            rowSlack(inDegree[v]);
+    }
+
+    // Scatter the arcs into their rows, keeping the input order within a row
+    m_ends.assign(m_offsets.begin(), m_offsets.end() - 1);
+    m_inEnds.assign(m_inOffsets.begin(), m_inOffsets.end() - 1);
+
+    m_targets.resize(m_offsets[vertexCount]);
+    m_weights.resize(m_offsets[vertexCount]);
+    m_edgeIds.resize(m_offsets[vertexCount]);
+    m_inSources.resize(m_inOffsets[vertexCount]);
+    m_inWeights.resize(m_inOffsets[vertexCount]);
+    m_inEdgeIds.resize(m_inOffsets[vertexCount]);
+    for (size_t i = 0; i < m_edges.size(); ++i) {
+        int e = static_cast<int>(i);
+        if (!hasEdge(e)) {
+            continue;
+        }
+
+        int a = m_ends[m_edges[e].source]++;
+        int b = m_inEnds[m_edges[e].target]++;
+
+        m_targets[a] = m_edges[e].target;
+        m_weights[a] = m_edges[e].weight;
+        m_edgeIds[a] = e;
+        m_arcOf[e]   = a;
+
+        m_inSources[b] = m_edges[e].source;
+        m_inWeights[b] = m_edges[e].weight;
+        m_inEdgeIds[b] = e;
+        m_inArcOf[e]   = b;
+    }
+}
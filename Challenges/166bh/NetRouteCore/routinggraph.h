@@ -0,0 +1,122 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef ROUTINGGRAPH_H
+#define ROUTINGGRAPH_H
+
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+
+// Path costs; INT_MAX marks a vertex that has not (yet) been reached
+typedef int Distance;
+static const Distance Unreachable = INT_MAX;
+
+// A single directed link as read from the problem specification
+struct RoutingEdge
+{
+    int         source;
+    int         target;
+    int         weight;
+
+    RoutingEdge(int source_ = 0, int target_ = 0, int weight_ = 0)
+        : source(source_)
+        , target(target_)
+        , weight(weight_)
+    {
+    }
+};
+
+
+// Which engine routeNetwork() uses for start/end queries
+enum RoutingAlgorithm {
+    DijkstraRouting         = 0,
+    BidirectionalRouting    = 1,
+    AltRouting              = 2,
+    ChRouting               = 3,
+    YenRouting              = 4,
+    DeltaSteppingRouting    = 5,
+    BoostRouting            = 6,
+};
+
+
+// Compact, scene-independent view of the network used by the routing
+// engines.  Vertices are the dense DigraphVertex indices and the outgoing
+// arcs of each vertex are stored contiguously (CSR), as are the incoming
+// arcs for the searches that run backwards from a target.  Every arc
+// remembers the index of the RoutingEdge it came from so that results can be
+// mapped back onto EdgeItems.
+//
+// Each row is laid out with some spare room so that edges can be added,
+// removed and re-weighted in place.  Edge indices stay stable across edits;
+// a removed edge simply has no arcs any more.
+class RoutingGraph
+{
+public:
+    RoutingGraph();
+
+    void build(int vertexCount, const std::vector<RoutingEdge>& edges);
+
+    // Builds straight from CSR arrays, e.g. a mapped NetworkFile; edges are
+    // numbered in arc order
+    void build(int vertexCount, const int* offsets, const int* targets,
+        const int* weights);
+    void clear();
+
+    int vertexCount() const { return m_vertexCount; }
+    int edgeCount() const { return static_cast<int>(m_edges.size()); }
+
+    const RoutingEdge& edge(int e) const { return m_edges[e]; }
+    bool hasEdge(int e) const { return m_arcOf[e] >= 0; }
+
+    // In-place edits; addEdge() returns the index of the new edge
+    void setEdgeWeight(int e, int weight);
+    int  addEdge(int source, int target, int weight);
+    void removeEdge(int e);
+
+    // Arc iteration: arcs of v are [firstArc(v), lastArc(v))
+    int firstArc(int v) const { return m_offsets[v]; }
+    int lastArc(int v) const { return m_ends[v]; }
+    int arcTarget(int a) const { return m_targets[a]; }
+    int arcWeight(int a) const { return m_weights[a]; }
+    int arcEdge(int a) const { return m_edgeIds[a]; }
+
+    // Reverse arc iteration: arcs into v are [firstInArc(v), lastInArc(v))
+    int firstInArc(int v) const { return m_inOffsets[v]; }
+    int lastInArc(int v) const { return m_inEnds[v]; }
+    int inArcSource(int a) const { return m_inSources[a]; }
+    int inArcWeight(int a) const { return m_inWeights[a]; }
+    int inArcEdge(int a) const { return m_inEdgeIds[a]; }
+
+private:
+    void layout();
+
+private:
+    int                         m_vertexCount;
+    std::vector<RoutingEdge>    m_edges;
+
+    // Rows span [m_offsets[v], m_ends[v]), with room up to m_offsets[v + 1]
+    std::vector<int>            m_offsets;
+    std::vector<int>            m_ends;
+    std::vector<int>            m_targets;
+    std::vector<int>            m_weights;
+    std::vector<int>            m_edgeIds;
+
+    std::vector<int>            m_inOffsets;
+    std::vector<int>            m_inEnds;
+    std::vector<int>            m_inSources;
+    std::vector<int>            m_inWeights;
+    std::vector<int>            m_inEdgeIds;
+
+    // Where each edge's arcs live, or -1 once it has been removed
+    std::vector<int>            m_arcOf;
+    std::vector<int>            m_inArcOf;
+};
+
+
+#endif  /* !ROUTINGGRAPH_H */
@@ -0,0 +1,348 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+
+#include "routingtable.h"
+#include "threadpool.h"
+
+// Large enough to never be a real path cost, small enough that adding two of
+// them together cannot overflow
+static const int Infinite = RoutingTable::CostLimit;
+
+
+RoutingTable::RoutingTable()
+    : m_vertexCount(0)
+    , m_stride(0)
+{
+}
+
+RoutingTable::Status RoutingTable::build(const RoutingGraph& graph,
+    ThreadPool* pool /* = nullptr */, JobProgress* progress /* = nullptr */)
+{
+    int n = graph.vertexCount();
+
+    clear();
+    if (n > MaxVertexCount) {
+        return TooManyNodes;
+    }
+
+    m_vertexCount = n;
+    m_stride      = (n + TileSize - 1) / TileSize * TileSize;
+
+    // Seed the matrices with the direct links; padding cells stay infinite
+    size_t cells = static_cast<size_t>(m_stride) * m_stride;
+    m_distance.assign(cells, Infinite);
+    m_next.assign(cells, -1);
+
+    for (int v = 0; v < m_stride; ++v) {
+        size_t cell = static_cast<size_t>(v) * m_stride + v;
+        m_distance[cell] = 0;
+        m_next[cell]     = v;
+    }
+
+    bool zeroWeights = false;
+    int  maxWeight   = 0;
+    for (int v = 0; v < n; ++v) {
+        int last = graph.lastArc(v);
+        for (int a = graph.firstArc(v); a < last; ++a) {
+            if (graph.arcWeight(a) >= Infinite) {
+                clear();
+                return CostTooLarge;
+            }
+            zeroWeights |= graph.arcWeight(a) == 0;
+            maxWeight    = std::max(maxWeight, graph.arcWeight(a));
+
+            int    w    = graph.arcTarget(a);
+            size_t cell = static_cast<size_t>(v) * m_stride + w;
+            if (graph.arcWeight(a) < m_distance[cell]) {
+                m_distance[cell] = graph.arcWeight(a);
+                m_next[cell]     = w;
+            }
+        }
+    }
+
+    // Blocked Floyd-Warshall, one round per pivot tile
+    int tiles = m_stride / TileSize;
+    if (progress) {
+        progress->setTotal(tiles);
+    }
+    for (int k = 0; k < tiles; ++k) {
+        if (progress && progress->isCancelled()) {
+            clear();
+            return Cancelled;
+        }
+
+        // Phase 1: the pivot tile only depends on itself
+        updateTile(k, k, k);
+
+        // Phase 2: the rest of the pivot row and column
+        ThreadPool::Task crossTask = [this, k, tiles] (int t, int) {
+            int other = t % (tiles - 1);
+            other += other >= k ? 1 : 0;
+
+            if (t < tiles - 1) {
+                updateTile(k, other, k);
+            } else {
+                updateTile(other, k, k);
+            }
+        };
+
+        // Phase 3: everything else, one row of tiles per task
+        ThreadPool::Task restTask = [this, k, tiles] (int row, int) {
+            if (row == k) {
+                return;
+            }
+            for (int col = 0; col < tiles; ++col) {
+                if (col != k) {
+                    updateTile(row, col, k);
+                }
+            }
+        };
+
+        if (tiles > 1) {
+            if (pool) {
+                pool->parallelFor(2 * (tiles - 1), crossTask);
+                pool->parallelFor(tiles, restTask);
+            } else {
+                for (int t = 0; t < 2 * (tiles - 1); ++t) {
+                    crossTask(t, 0);
+                }
+                for (int row = 0; row < tiles; ++row) {
+                    restTask(row, 0);
+                }
+            }
+        }
+
+        if (progress) {
+            progress->advance();
+        }
+    }
+
+    // Sums that reach the limit are never kept, so a path that costs too
+    // much looks just like no path at all.  Only a network whose longest
+    // simple path could get there needs telling apart.
+    if (static_cast<int64_t>(n - 1) * maxWeight >= Infinite &&
+            !reachesAll(graph, pool)) {
+        clear();
+        return CostTooLarge;
+    }
+
+    if (zeroWeights) {
+        rebuildNextHops(graph, pool);
+    }
+    return Built;
+}
+
+void RoutingTable::clear()
+{
+    m_vertexCount = 0;
+    m_stride      = 0;
+    m_distance.clear();
+    m_next.clear();
+}
+
+Distance RoutingTable::distance(int from, int to) const
+{
+    int d = m_distance[static_cast<size_t>(from) * m_stride + to];
+    return d < Infinite ? d : Unreachable;
+}
+
+int RoutingTable::nextHop(int from, int to) const
+{
+    if (from == to) {
+        return -1;
+    }
+    return m_next[static_cast<size_t>(from) * m_stride + to];
+}
+
+std::vector<int> RoutingTable::path(int from, int to) const
+{
+    std::vector<int> routers;
+    if (distance(from, to) == Unreachable) {
+        return routers;
+    }
+
+    // Follow the next hops until we arrive
+    routers.push_back(from);
+    for (int v = from; v != to; ) {
+        v = nextHop(v, to);
+        routers.push_back(v);
+    }
+
+    return routers;
+}
+
+void RoutingTable::rebuildNextHops(const RoutingGraph& graph,
+    ThreadPool* pool)
+{
+    int n = m_vertexCount;
+
+    // Per-thread breadth-first search state
+    int threads = pool ? pool->threadCount() : 1;
+    std::vector<std::vector<int> > queues(threads);
+    std::vector<std::vector<int> > marks(threads, std::vector<int>(n, -1));
+
+    // Grow a tree of tight links back from every destination, so that every
+    // next hop is one step closer to it by hop count as well as by cost
+    ThreadPool::Task task = [&] (int to, int thread) {
+        std::vector<int>& queue = queues[thread];
+        std::vector<int>& mark  = marks[thread];
+
+        queue.assign(1, to);
+        mark[to] = to;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int    w     = queue[head];
+            size_t cellW = static_cast<size_t>(w) * m_stride + to;
+
+            int last = graph.lastInArc(w);
+            for (int a = graph.firstInArc(w); a < last; ++a) {
+                int    u     = graph.inArcSource(a);
+                size_t cellU = static_cast<size_t>(u) * m_stride + to;
+                if (mark[u] == to || m_distance[cellU] >= Infinite ||
+                        graph.inArcWeight(a) + m_distance[cellW] !=
+                            m_distance[cellU]) {
+                    continue;
+                }
+
+                mark[u]       = to;
+                m_next[cellU] = w;
+                queue.push_back(u);
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(n, task);
+    } else {
+        for (int to = 0; to < n; ++to) {
+            task(to, 0);
+        }
+    }
+}
+
+bool RoutingTable::reachesAll(const RoutingGraph& graph,
+    ThreadPool* pool) const
+{
+    int n = m_vertexCount;
+
+    // Per-thread breadth-first search state
+    int threads = pool ? pool->threadCount() : 1;
+    std::vector<std::vector<int> > queues(threads);
+    std::vector<std::vector<int> > marks(threads, std::vector<int>(n, -1));
+    std::atomic<bool>              reached(true);
+
+    // Everything a router can get to by following links must have a cost
+    ThreadPool::Task task = [&] (int from, int thread) {
+        std::vector<int>& queue = queues[thread];
+        std::vector<int>& mark  = marks[thread];
+        size_t            row   = static_cast<size_t>(from) * m_stride;
+
+        queue.assign(1, from);
+        mark[from] = from;
+        for (size_t head = 0; head < queue.size() && reached; ++head) {
+            int v = queue[head];
+            if (m_distance[row + v] >= Infinite) {
+                reached = false;
+            }
+
+            int last = graph.lastArc(v);
+            for (int a = graph.firstArc(v); a < last; ++a) {
+                int w = graph.arcTarget(a);
+                if (mark[w] != from) {
+                    mark[w] = from;
+                    queue.push_back(w);
+                }
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(n, task);
+    } else {
+        for (int from = 0; from < n && reached; ++from) {
+            task(from, 0);
+        }
+    }
+    return reached;
+}
+
+void RoutingTable::updateTile(int row, int col, int pivot)
+{
+    int*   dist   = m_distance.data();
+    int*   next   = m_next.data();
+    size_t stride = m_stride;
+
+    int rowStart   = row * TileSize;
+    int colStart   = col * TileSize;
+    int pivotStart = pivot * TileSize;
+
+    for (int k = pivotStart; k < pivotStart + TileSize; ++k) {
+        const int* distK = dist + k * stride + colStart;
+
+        for (int i = rowStart; i < rowStart + TileSize; ++i) {
+            int  dik   = dist[i * stride + k];
+            int  nik   = next[i * stride + k];
+            int* distI = dist + i * stride + colStart;
+            int* nextI = next + i * stride + colStart;
+
+            // Nothing passes through k from here
+            if (dik >= Infinite) {
+                continue;
+            }
+
+            int j = 0;
+#if defined(__AVX2__)
+            __m256i vdik = _mm256_set1_epi32(dik);
+            __m256i vnik = _mm256_set1_epi32(nik);
+            for (; j < TileSize; j += 8) {
+                __m256i viaK = _mm256_add_epi32(vdik,
+                    _mm256_loadu_si256((const __m256i*) (distK + j)));
+                __m256i cur  = _mm256_loadu_si256((const __m256i*) (distI + j));
+                __m256i mask = _mm256_cmpgt_epi32(cur, viaK);
+
+                _mm256_storeu_si256((__m256i*) (distI + j),
+                    _mm256_min_epi32(cur, viaK));
+                _mm256_storeu_si256((__m256i*) (nextI + j),
+                    _mm256_blendv_epi8(
+                        _mm256_loadu_si256((const __m256i*) (nextI + j)),
+                        vnik, mask));
+            }
+#elif defined(__SSE4_1__)
+            __m128i vdik = _mm_set1_epi32(dik);
+            __m128i vnik = _mm_set1_epi32(nik);
+            for (; j < TileSize; j += 4) {
+                __m128i viaK = _mm_add_epi32(vdik,
+                    _mm_loadu_si128((const __m128i*) (distK + j)));
+                __m128i cur  = _mm_loadu_si128((const __m128i*) (distI + j));
+                __m128i mask = _mm_cmpgt_epi32(cur, viaK);
+
+                _mm_storeu_si128((__m128i*) (distI + j),
+                    _mm_min_epi32(cur, viaK));
+                _mm_storeu_si128((__m128i*) (nextI + j),
+                    _mm_blendv_epi8(
+                        _mm_loadu_si128((const __m128i*) (nextI + j)),
+                        vnik, mask));
+            }
+#endif
+            for (; j < TileSize; ++j) {
+                int viaK = dik + distK[j];
+                if (viaK < distI[j]) {
+                    distI[j] = viaK;
+                    nextI[j] = nik;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef ROUTINGTABLE_H
+#define ROUTINGTABLE_H
+
+#include <vector>
+
+#include "jobprogress.h"
+#include "routinggraph.h"
+
+class ThreadPool;
+
+
+// All-pairs shortest paths, i.e. the next-hop table of every router.
+//
+// The table is computed with a cache-blocked Floyd-Warshall over a
+// contiguous, row-major distance matrix whose rows are padded to a whole
+// number of tiles.  Each round updates the diagonal tile, then the tiles in
+// its row and column, then every remaining tile; the last two phases are
+// spread across a ThreadPool and the inner loop is vectorised with AVX2 or
+// SSE4.1 when the compiler targets them.  Path costs must stay below
+// CostLimit; a network that could exceed it is refused rather than having
+// its dearest routes shown as unreachable.
+//
+// Zero-weight links can leave ties that make the next hops chase each other
+// round a cycle, so when the network has any of those the next hops are
+// rebuilt from the final distances by a breadth-first search per router.
+class RoutingTable
+{
+public:
+    // Outcomes of build(); anything but Built leaves the table empty
+    enum Status {
+        Built,
+        TooManyNodes,
+        CostTooLarge,
+        Cancelled,
+    };
+
+    RoutingTable();
+
+    Status build(const RoutingGraph& graph, ThreadPool* pool = nullptr,
+                 JobProgress* progress = nullptr);
+    void clear();
+
+    bool isEmpty() const { return m_vertexCount == 0; }
+    int vertexCount() const { return m_vertexCount; }
+
+    // Cost of the cheapest path from -> to, or Unreachable
+    Distance distance(int from, int to) const;
+
+    // First router after from on the way to to, or -1 if there is none
+    int nextHop(int from, int to) const;
+
+    // Routers visited from -> to inclusive; empty when unreachable
+    std::vector<int> path(int from, int to) const;
+
+    // Tile edge length, in matrix cells
+    static const int TileSize = 64;
+
+    // Largest network build() takes on; the two matrices cost 8 bytes per
+    // pair of routers, which is 512 MB at this size
+    static const int MaxVertexCount = 8192;
+
+    // Every link and every path must cost less than this, so that adding
+    // two costs together cannot overflow
+    static const Distance CostLimit = INT_MAX / 2;
+
+private:
+    void updateTile(int row, int col, int pivot);
+    void rebuildNextHops(const RoutingGraph& graph, ThreadPool* pool);
+    bool reachesAll(const RoutingGraph& graph, ThreadPool* pool) const;
+
+private:
+    int                 m_vertexCount;
+    int                 m_stride;
+
+    std::vector<int>    m_distance;
+    std::vector<int>    m_next;
+};
+
+
+#endif  /* !ROUTINGTABLE_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef SEARCHSPACE_H
+#define SEARCHSPACE_H
+
+#include <vector>
+
+#include "indexedheap.h"
+#include "routinggraph.h"
+
+
+// Labels and queue for one direction of a Dijkstra-style search.  Only the
+// entries touched by a search are reset before the next one.
+struct SearchSpace
+{
+    std::vector<Distance>   distance;
+    std::vector<int>        edge;
+    std::vector<int>        touched;
+    IndexedHeap             heap;
+    int                     settled;
+
+    SearchSpace() : settled(0) {}
+
+    void resize(int vertexCount)
+    {
+        distance.assign(vertexCount, Unreachable);
+        edge.assign(vertexCount, -1);
+        touched.clear();
+        heap.resize(vertexCount);
+        settled = 0;
+    }
+
+    void reset()
+    {
+        for (size_t i = 0; i < touched.size(); ++i) {
+            distance[touched[i]] = Unreachable;
+            edge[touched[i]]     = -1;
+        }
+        touched.clear();
+        heap.clear();
+        settled = 0;
+    }
+
+    void seed(int v)
+    {
+        distance[v] = 0;
+        touched.push_back(v);
+        heap.push(v, 0);
+    }
+
+    // Records a better label for v; returns false if it is no improvement
+    bool relax(int v, Distance dist, int viaEdge)
+    {
+        if (dist >= distance[v]) {
+            return false;
+        }
+        if (distance[v] == Unreachable) {
+            touched.push_back(v);
+        }
+
+        distance[v] = dist;
+        edge[v]     = viaEdge;
+        heap.push(v, dist);
+        return true;
+    }
+};
+
+
+#endif  /* !SEARCHSPACE_H */
@@ -0,0 +1,166 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "sessionfile.h"
+
+const char SessionFile::Magic[8] = { 'N', 'E', 'T', 'S', 'T', 'A', 'T', 'E' };
+
+// Sections start on 8-byte boundaries, as in a NetworkFile
+static uint64_t padded(uint64_t bytes)
+{
+    return (bytes + 7) & ~static_cast<uint64_t>(7);
+}
+
+static bool writeSection(FILE* file, const void* data, size_t size,
+    size_t count)
+{
+    static const char zeros[8] = { 0 };
+
+    uint64_t bytes = static_cast<uint64_t>(size) * count;
+    if (count > 0 && fwrite(data, size, count, file) != count) {
+        return false;
+    }
+
+    size_t padding = static_cast<size_t>(padded(bytes) - bytes);
+    return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+}
+
+
+SessionFile::SessionFile()
+    : m_positions(nullptr)
+    , m_routeSource(-1)
+    , m_routeTarget(-1)
+    , m_routeLength(0)
+    , m_route(nullptr)
+    , m_style(0)
+    , m_algorithm(DijkstraRouting)
+{
+}
+
+SessionFile::Status SessionFile::read(const char* data, size_t size)
+{
+    if (!isSessionFile(data, size)) {
+        return BadMagic;
+    }
+    if (size < sizeof(Header)) {
+        return Truncated;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != CurrentVersion) {
+        return BadVersion;
+    }
+    if (header.vertexCount > INT_MAX / 2 || header.routeLength > INT_MAX ||
+            header.algorithm > BoostRouting) {
+        return Corrupt;
+    }
+    if (header.networkBytes > size) {
+        return Truncated;
+    }
+
+    uint64_t networkAt   = padded(sizeof(Header));
+    uint64_t positionsAt = networkAt + padded(header.networkBytes);
+    uint64_t routeAt     = positionsAt + 16 * uint64_t(header.vertexCount);
+    uint64_t end         = routeAt + padded(4 * uint64_t(header.routeLength));
+    if (end > size) {
+        return Truncated;
+    }
+
+    // The network checks itself
+    switch (m_network.read(data + networkAt,
+            static_cast<size_t>(header.networkBytes))) {
+    case NetworkFile::Valid:
+        break;
+    case NetworkFile::Truncated:
+        return Truncated;
+    case NetworkFile::BadVersion:
+        return BadVersion;
+    default:
+        return Corrupt;
+    }
+
+    int n = m_network.vertexCount();
+    if (static_cast<uint32_t>(n) != header.vertexCount) {
+        return Corrupt;
+    }
+
+    m_positions   = reinterpret_cast<const double*>(data + positionsAt);
+    m_routeSource = header.routeSource;
+    m_routeTarget = header.routeTarget;
+    m_routeLength = static_cast<int>(header.routeLength);
+    m_route       = reinterpret_cast<const int*>(data + routeAt);
+    m_style       = header.style;
+    m_algorithm   = static_cast<RoutingAlgorithm>(header.algorithm);
+
+    bool valid = true;
+    for (int i = 0; i < 2 * n; ++i) {
+        valid &= std::isfinite(m_positions[i]);
+    }
+
+    // A route needs both ends, and its edges must exist
+    if ((m_routeSource < 0) != (m_routeTarget < 0) ||
+            m_routeSource >= n || m_routeTarget >= n ||
+            (m_routeSource < 0 && m_routeLength > 0)) {
+        return Corrupt;
+    }
+    for (int i = 0; i < m_routeLength; ++i) {
+        valid &= static_cast<unsigned>(m_route[i]) <
+            static_cast<unsigned>(m_network.edgeCount());
+    }
+
+    return valid ? Valid : Corrupt;
+}
+
+bool SessionFile::isSessionFile(const char* data, size_t size)
+{
+    return size >= sizeof(Magic) && memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+bool SessionFile::write(const std::string& fileName, const SymbolTable& names,
+    const std::vector<RoutingEdge>& edges,
+    const std::vector<std::pair<int, int> >& queries,
+    const std::vector<double>& positions, int routeSource, int routeTarget,
+    const std::vector<int>& route, unsigned style, RoutingAlgorithm algorithm)
+{
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version     = CurrentVersion;
+    header.vertexCount = static_cast<uint32_t>(names.size());
+    header.routeSource = routeSource;
+    header.routeTarget = routeTarget;
+    header.routeLength = static_cast<uint32_t>(route.size());
+    header.style       = style;
+    header.algorithm   = static_cast<uint32_t>(algorithm);
+
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    // The network's size is only known once it has been written, so the
+    // header goes in twice
+    bool ok = writeSection(file, &header, sizeof(header), 1) &&
+        NetworkFile::write(file, names, edges, queries);
+    if (ok) {
+        header.networkBytes = static_cast<uint64_t>(ftell(file)) -
+            padded(sizeof(Header));
+    }
+
+    ok = ok && writeSection(file, positions.data(), 8, positions.size()) &&
+        writeSection(file, route.data(), 4, route.size()) &&
+        fseek(file, 0, SEEK_SET) == 0 &&
+        writeSection(file, &header, sizeof(header), 1);
+
+    return fclose(file) == 0 && ok;
+}
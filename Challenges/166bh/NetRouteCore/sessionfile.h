@@ -0,0 +1,111 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "networkfile.h"
+#include "routinggraph.h"
+#include "symboltable.h"
+
+
+// Snapshot of everything the explorer shows, so that a network can be
+// reopened without laying it out or routing it again.
+//
+// The network itself is a complete NetworkFile image, and the rest follows
+// it.  Each section starts on an 8-byte boundary:
+//
+//     Header
+//     char    network[networkBytes]            a NetworkFile
+//     double  positions[2 * vertexCount]       x, y of every node
+//     int32   route[routeLength]               edges, start to end
+//
+// Route edges are numbered as the embedded network numbers them.  A route
+// source or target of -1 means no route had been drawn.
+class SessionFile
+{
+public:
+    enum Status {
+        Valid,
+        BadMagic,
+        BadVersion,
+        Truncated,
+        Corrupt,
+    };
+
+    // What the display options were set to
+    enum StyleFlags {
+        HighlightStart  = 0x01,
+        HighlightEnd    = 0x02,
+        HighlightPath   = 0x04,
+    };
+
+    struct Header
+    {
+        char        magic[8];
+        uint32_t    version;
+        uint32_t    vertexCount;
+        uint64_t    networkBytes;
+        int32_t     routeSource;
+        int32_t     routeTarget;
+        uint32_t    routeLength;
+        uint32_t    style;
+        uint32_t    algorithm;
+        uint32_t    reserved;
+    };
+
+    static const uint32_t CurrentVersion = 1;
+
+    SessionFile();
+
+    // As NetworkFile::read(); the image must outlive the accessors
+    Status read(const char* data, size_t size);
+
+    static bool isSessionFile(const char* data, size_t size);
+
+    const NetworkFile& network() const { return m_network; }
+
+    double x(int v) const { return m_positions[2 * v]; }
+    double y(int v) const { return m_positions[2 * v + 1]; }
+
+    int routeSource() const { return m_routeSource; }
+    int routeTarget() const { return m_routeTarget; }
+    int routeLength() const { return m_routeLength; }
+    int routeEdge(int i) const { return m_route[i]; }
+
+    unsigned style() const { return m_style; }
+    RoutingAlgorithm algorithm() const { return m_algorithm; }
+
+    // Writes a snapshot.  The edges must be sorted by source, and positions
+    // holds an x, y pair for every node.
+    static bool write(const std::string& fileName, const SymbolTable& names,
+        const std::vector<RoutingEdge>& edges,
+        const std::vector<std::pair<int, int> >& queries,
+        const std::vector<double>& positions, int routeSource,
+        int routeTarget, const std::vector<int>& route, unsigned style,
+        RoutingAlgorithm algorithm);
+
+private:
+    static const char Magic[8];
+
+    NetworkFile         m_network;
+    const double*       m_positions;
+    int                 m_routeSource;
+    int                 m_routeTarget;
+    int                 m_routeLength;
+    const int*          m_route;
+    unsigned            m_style;
+    RoutingAlgorithm    m_algorithm;
+};
+
+
+#endif  /* !SESSIONFILE_H */
@@ -0,0 +1,170 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+
+#include "shortestpathtree.h"
+
+ShortestPathTree::ShortestPathTree(const RoutingGraph* graph /* = nullptr */)
+    : m_graph(nullptr)
+    , m_source(-1)
+{
+    setGraph(graph);
+}
+
+void ShortestPathTree::setGraph(const RoutingGraph* graph)
+{
+    int n = graph ? graph->vertexCount() : 0;
+
+    m_graph  = graph;
+    m_source = -1;
+    m_distance.assign(n, Unreachable);
+    m_predecessor.assign(n, -1);
+    m_heap.resize(n);
+    m_affected.assign(n, false);
+    m_affectedList.clear();
+}
+
+void ShortestPathTree::build(int source)
+{
+    std::fill(m_distance.begin(), m_distance.end(), Unreachable);
+    std::fill(m_predecessor.begin(), m_predecessor.end(), -1);
+    m_heap.clear();
+
+    m_source           = source;
+    m_distance[source] = 0;
+    m_heap.push(source, 0);
+    propagate();
+}
+
+int ShortestPathTree::edgeImproved(int e)
+{
+    if (!m_graph->hasEdge(e)) {
+        return 0;
+    }
+
+    const RoutingEdge& edge = m_graph->edge(e);
+    Distance           from = m_distance[edge.source];
+    if (from == Unreachable || edge.weight > Unreachable - from ||
+            from + edge.weight >= m_distance[edge.target]) {
+        return 0;
+    }
+
+    // Only what is downstream of the new route can improve
+    m_distance[edge.target]    = from + edge.weight;
+    m_predecessor[edge.target] = e;
+    m_heap.push(edge.target, m_distance[edge.target]);
+
+    return propagate();
+}
+
+int ShortestPathTree::edgeWorsened(int e)
+{
+    const RoutingEdge& edge = m_graph->edge(e);
+    if (m_predecessor[edge.target] != e) {
+        // Not part of the tree, so no route got any longer
+        return 0;
+    }
+
+    // Cut off the subtree that hangs from the edge
+    m_affectedList.clear();
+    m_affectedList.push_back(edge.target);
+    m_affected[edge.target] = true;
+    for (size_t i = 0; i < m_affectedList.size(); ++i) {
+        int v    = m_affectedList[i];
+        int last = m_graph->lastArc(v);
+        for (int a = m_graph->firstArc(v); a < last; ++a) {
+            int w = m_graph->arcTarget(a);
+            if (m_predecessor[w] == m_graph->arcEdge(a) && !m_affected[w]) {
+                m_affected[w] = true;
+                m_affectedList.push_back(w);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_affectedList.size(); ++i) {
+        m_distance[m_affectedList[i]]    = Unreachable;
+        m_predecessor[m_affectedList[i]] = -1;
+    }
+
+    // Each cut node takes the best route offered by the intact part of the
+    // tree, then the usual search sorts out routes within the subtree
+    for (size_t i = 0; i < m_affectedList.size(); ++i) {
+        int v    = m_affectedList[i];
+        int last = m_graph->lastInArc(v);
+        for (int a = m_graph->firstInArc(v); a < last; ++a) {
+            int      u    = m_graph->inArcSource(a);
+            Distance from = m_distance[u];
+            if (m_affected[u] || from == Unreachable ||
+                    m_graph->inArcWeight(a) > Unreachable - from) {
+                continue;
+            }
+
+            Distance dist = from + m_graph->inArcWeight(a);
+            if (dist < m_distance[v]) {
+                m_distance[v]    = dist;
+                m_predecessor[v] = m_graph->inArcEdge(a);
+            }
+        }
+
+        if (m_distance[v] != Unreachable) {
+            m_heap.push(v, m_distance[v]);
+        }
+    }
+
+    for (size_t i = 0; i < m_affectedList.size(); ++i) {
+        m_affected[m_affectedList[i]] = false;
+    }
+
+    propagate();
+    return static_cast<int>(m_affectedList.size());
+}
+
+std::vector<int> ShortestPathTree::path(int target) const
+{
+    std::vector<int> edges;
+
+    // Walk backwards from the target to the source, then flip it over
+    for (int e = m_predecessor[target]; e >= 0;
+            e = m_predecessor[m_graph->edge(e).source]) {
+        edges.push_back(e);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return edges;
+}
+
+int ShortestPathTree::propagate()
+{
+    int settled = 0;
+
+    // Plain Dijkstra from whatever has been queued
+    while (!m_heap.empty()) {
+        int      current = m_heap.pop();
+        Distance dist    = m_distance[current];
+
+        settled += 1;
+
+        int last = m_graph->lastArc(current);
+        for (int a = m_graph->firstArc(current); a < last; ++a) {
+            int weight = m_graph->arcWeight(a);
+            if (weight > Unreachable - dist) {
+                continue;
+            }
+
+            int      neighbour = m_graph->arcTarget(a);
+            Distance newDist   = dist + weight;
+            if (newDist < m_distance[neighbour]) {
+                m_distance[neighbour]    = newDist;
+                m_predecessor[neighbour] = m_graph->arcEdge(a);
+                m_heap.push(neighbour, newDist);
+            }
+        }
+    }
+
+    return settled;
+}
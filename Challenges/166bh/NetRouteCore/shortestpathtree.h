@@ -0,0 +1,67 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef SHORTESTPATHTREE_H
+#define SHORTESTPATHTREE_H
+
+#include <vector>
+
+#include "indexedheap.h"
+#include "routinggraph.h"
+
+
+// Complete tree of shortest paths out of one source that is kept up to date
+// as the graph is edited, rather than being rebuilt.
+//
+// After an edge gets cheaper (or is added) only the nodes it now gives a
+// better route to are searched again.  After a tree edge gets dearer (or is
+// removed) its subtree is cut off, each cut node takes the best offer from
+// the rest of the tree, and a Dijkstra confined to the subtree settles the
+// rest.  This follows Ramalingam and Reps, so the work done depends on how
+// much of the tree changed rather than on the size of the network.
+class ShortestPathTree
+{
+public:
+    ShortestPathTree(const RoutingGraph* graph = nullptr);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    // Runs a full Dijkstra from source
+    void build(int source);
+    int  source() const { return m_source; }
+
+    // Repair the tree once edge e has been edited in the graph.  Both return
+    // how many nodes had their distance recomputed.
+    int edgeImproved(int e);
+    int edgeWorsened(int e);
+
+    Distance distance(int v) const { return m_distance[v]; }
+    int  predecessorEdge(int v) const { return m_predecessor[v]; }
+    bool isReached(int v) const { return m_distance[v] != Unreachable; }
+
+    // Edge indices of the path to target, ordered start to end
+    std::vector<int> path(int target) const;
+
+private:
+    int propagate();
+
+private:
+    const RoutingGraph*     m_graph;
+    int                     m_source;
+
+    std::vector<Distance>   m_distance;
+    std::vector<int>        m_predecessor;
+    IndexedHeap             m_heap;
+
+    // Subtree cut off by edgeWorsened()
+    std::vector<bool>       m_affected;
+    std::vector<int>        m_affectedList;
+};
+
+
+#endif  /* !SHORTESTPATHTREE_H */
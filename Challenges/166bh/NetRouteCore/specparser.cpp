@@ -0,0 +1,369 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+// MSVC never defines __SSE2__, but every x64 target it builds for has it
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+
+#include "specparser.h"
+#include "threadpool.h"
+
+// The characters QString::trimmed() strips, as far as ASCII goes
+static bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+#if defined(HAVE_SSE2)
+// Position of the lowest set bit of a mask that is not zero
+static int lowestBit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return static_cast<int>(bit);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+
+SpecParser::SpecParser()
+{
+    clear();
+}
+
+SpecParser::Status SpecParser::parse(const char* data, size_t size,
+                                     ThreadPool* pool /* = nullptr */)
+{
+    const char* end = data + size;
+
+    clear();
+
+    // One quick pass for the line boundaries.  Empty lines do not count for
+    // anything, as with QString::split().
+    std::vector<const char*> lines;
+    for (const char* p = data; p < end; ) {
+        const char* eol = findLineEnd(p, end);
+
+        if (eol > p) {
+            lines.push_back(p);
+            lines.push_back(eol);
+        }
+
+        p = eol < end ? eol + 1 : end;
+    }
+
+    m_lineCount = static_cast<int>(lines.size() / 2);
+    if (m_lineCount > 0) {
+        parseHeader(lines[0], lines[1]);
+    }
+
+    // The rows only depend on the header, so they are parsed in chunks
+    int rowCount   = hasAllRows() ? m_nodeCount : 0;
+    int chunkCount = (rowCount + RowsPerChunk - 1) / RowsPerChunk;
+    std::vector<Chunk> chunks(chunkCount);
+
+    ThreadPool::Task rowTask = [this, &lines, &chunks, rowCount] (int c, int) {
+        Chunk& chunk = chunks[c];
+        int    first = c * RowsPerChunk;
+        int    last  = std::min(first + RowsPerChunk, rowCount);
+
+        // Past a bad row there is nothing more to gather
+        for (int row = first; row < last; ++row) {
+            int length = parseRow(row, lines[2 * row + 2], lines[2 * row + 3],
+                chunk.edges, chunk.badCells);
+            if (length != m_nodeCount) {
+                chunk.shortRow       = row;
+                chunk.shortRowLength = length;
+                break;
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(chunkCount, rowTask);
+    } else {
+        for (int c = 0; c < chunkCount; ++c) {
+            rowTask(c, 0);
+        }
+    }
+
+    // Merge in row order, up to the first bad row, so the results do not
+    // depend on how the chunks were scheduled
+    Status rows = Parsed;
+    merge(chunks, pool);
+    for (int c = 0; c < chunkCount; ++c) {
+        if (chunks[c].shortRow >= 0) {
+            rows             = ShortRow;
+            m_shortRow       = chunks[c].shortRow;
+            m_shortRowLength = chunks[c].shortRowLength;
+            break;
+        }
+    }
+
+    // Start/end lines follow the last row, if it is there at all
+    int firstQuery = hasAllRows() ? m_nodeCount + 1 : m_lineCount;
+    for (int i = firstQuery; i < m_lineCount; ++i) {
+        m_queries.push_back(std::string(lines[2 * i], lines[2 * i + 1]));
+    }
+
+    // Report problems in the order the explorer has always checked for them
+    if (m_lineCount == 0) {
+        m_status = Empty;
+    } else if (!hasAllRows()) {
+        m_status = TooFewLines;
+    } else if (m_status == Parsed) {
+        m_status = rows;
+    }
+
+    return m_status;
+}
+
+void SpecParser::clear()
+{
+    m_status         = Parsed;
+    m_nodeCount      = 0;
+    m_lineCount      = 0;
+    m_nameCount      = 0;
+    m_shortRow       = -1;
+    m_shortRowLength = 0;
+
+    m_names.clear();
+    m_edges.clear();
+    m_badCells.clear();
+    m_queries.clear();
+    m_duplicate.clear();
+}
+
+bool SpecParser::parseCell(const char* begin, const char* end, int& value)
+{
+    while (begin < end && isSpace(*begin)) {
+        ++begin;
+    }
+    while (end > begin && isSpace(end[-1])) {
+        --end;
+    }
+
+    bool negative = false;
+    if (begin < end && (*begin == '-' || *begin == '+')) {
+        negative = *begin == '-';
+        ++begin;
+    }
+    if (begin == end) {
+        return false;
+    }
+
+    // One past INT_MAX is still fine when negative
+    long long magnitude = 0;
+    for (; begin < end; ++begin) {
+        unsigned digit = static_cast<unsigned char>(*begin) - '0';
+        if (digit > 9) {
+            return false;
+        }
+
+        magnitude = magnitude * 10 + digit;
+        if (magnitude > static_cast<long long>(INT_MAX) + 1) {
+            return false;
+        }
+    }
+
+    if (!negative && magnitude > INT_MAX) {
+        return false;
+    }
+
+    value = static_cast<int>(negative ? -magnitude : magnitude);
+    return true;
+}
+
+void SpecParser::parseHeader(const char* begin, const char* end)
+{
+    std::vector<std::pair<const char*, const char*> > tokens;
+
+    // Node count then names, separated by any run of spaces and commas
+    for (const char* p = begin; p < end; ) {
+        while (p < end && (isSpace(*p) || *p == ',')) {
+            ++p;
+        }
+
+        const char* token = p;
+        while (p < end && !isSpace(*p) && *p != ',') {
+            ++p;
+        }
+        if (p > token) {
+            tokens.push_back(std::make_pair(token, p));
+        }
+    }
+
+    if (tokens.empty() ||
+            !parseCell(tokens[0].first, tokens[0].second, m_nodeCount)) {
+        m_nodeCount = 0;
+    }
+    m_nodeCount = std::max(m_nodeCount, 0);
+    m_nameCount = static_cast<int>(tokens.size()) - 1;
+
+    // Nothing is set aside for the nodes until the rows are known to be
+    // there: the count may be anything up to INT_MAX
+    if (!hasAllRows()) {
+        return;
+    }
+
+    // Unnamed nodes are labelled A..Z, AA..AZ, etc.
+    bool named = m_nameCount > 0;
+    if (named && m_nameCount != m_nodeCount) {
+        m_status = BadNodeNames;
+        return;
+    }
+
+    m_names.reserve(m_nodeCount);
+    for (int i = 0; i < m_nodeCount; ++i) {
+        std::string name = named
+            ? std::string(tokens[i + 1].first, tokens[i + 1].second)
+            : SymbolTable::defaultName(i);
+
+        if (m_names.intern(name) != i) {
+            m_status    = DuplicateName;
+            m_duplicate = name;
+            return;
+        }
+    }
+}
+
+int SpecParser::parseRow(int row, const char* begin, const char* end,
+    std::vector<RoutingEdge>& edges, std::vector<BadCell>& badCells) const
+{
+    size_t edgeCount = edges.size();
+    size_t badCount  = badCells.size();
+    int    column    = 0;
+
+    while (begin < end && isSpace(*begin)) {
+        ++begin;
+    }
+    while (end > begin && isSpace(end[-1])) {
+        --end;
+    }
+
+    // Empty cells between commas are skipped; columns past the end of the
+    // matrix are only counted
+    auto addCell = [this, row, &column, &edges, &badCells] (const char* cell,
+                                                          const char* comma) {
+        if (comma == cell) {
+            return;
+        }
+
+        if (column < m_nodeCount) {
+            int weight;
+            if (!parseCell(cell, comma, weight)) {
+                BadCell bad = { row, column, std::string(cell, comma) };
+                badCells.push_back(bad);
+            } else if (weight >= 0) {
+                edges.push_back(RoutingEdge(row, column, weight));
+            }
+        }
+        column += 1;
+    };
+
+    const char* cell = begin;
+    const char* p    = begin;
+#if defined(HAVE_SSE2)
+    const __m128i commas = _mm_set1_epi8(',');
+    for (; p + 16 <= end; p += 16) {
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i*) p), commas));
+        while (mask) {
+            const char* comma = p + lowestBit(mask);
+            mask &= mask - 1;
+
+            addCell(cell, comma);
+            cell = comma + 1;
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == ',') {
+            addCell(cell, p);
+            cell = p + 1;
+        }
+    }
+    addCell(cell, end);
+
+    // A row of the wrong length contributes nothing
+    if (column != m_nodeCount) {
+        edges.resize(edgeCount);
+        badCells.resize(badCount);
+    }
+
+    return column;
+}
+
+void SpecParser::merge(const std::vector<Chunk>& chunks, ThreadPool* pool)
+{
+    // Everything up to and including the chunk holding the first bad row
+    std::vector<size_t> edgeStart(1, 0);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        edgeStart.push_back(edgeStart.back() + chunks[c].edges.size());
+
+        for (size_t i = 0; i < chunks[c].badCells.size(); ++i) {
+            m_badCells.push_back(chunks[c].badCells[i]);
+        }
+        if (chunks[c].shortRow >= 0) {
+            break;
+        }
+    }
+
+    // One allocation for all the edges, filled in parallel
+    int used = static_cast<int>(edgeStart.size()) - 1;
+    m_edges.resize(edgeStart.back());
+
+    ThreadPool::Task copyTask = [this, &chunks, &edgeStart] (int c, int) {
+        std::copy(chunks[c].edges.begin(), chunks[c].edges.end(),
+            m_edges.begin() + edgeStart[c]);
+    };
+
+    if (pool) {
+        pool->parallelFor(used, copyTask);
+    } else {
+        for (int c = 0; c < used; ++c) {
+            copyTask(c, 0);
+        }
+    }
+}
+
+const char* SpecParser::findLineEnd(const char* begin, const char* end)
+{
+    const char* p = begin;
+
+#if defined(HAVE_SSE2)
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i returns  = _mm_set1_epi8('\r');
+    for (; p + 16 <= end; p += 16) {
+        __m128i  chunk = _mm_loadu_si128((const __m128i*) p);
+        unsigned mask  = _mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, newlines), _mm_cmpeq_epi8(chunk, returns)));
+        if (mask) {
+            return p + lowestBit(mask);
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '\n' || *p == '\r') {
+            return p;
+        }
+    }
+
+    return end;
+}
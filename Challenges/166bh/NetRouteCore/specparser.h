@@ -0,0 +1,133 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef SPECPARSER_H
+#define SPECPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "routinggraph.h"
+#include "symboltable.h"
+
+class ThreadPool;
+
+
+// Reads a problem specification straight out of a byte buffer, such as a
+// memory-mapped file, without building any intermediate strings.
+//
+// The format is the one the explorer has always accepted: a node count,
+// optionally followed by the node names, then one comma-separated row of the
+// adjacency matrix per line, then any number of start/end lines.  Empty lines
+// are skipped and empty cells between commas are ignored.  Line ends and
+// commas are found sixteen bytes at a time with SSE2 where the compiler
+// targets it, and each cell is converted to an integer in place.  A node
+// count with too few lines after it is rejected before any names or rows
+// are looked at, so a bogus count cannot exhaust memory.
+//
+// Each row only yields its own edges, so once the line boundaries are known
+// the rows are parsed in chunks across a ThreadPool.  Every chunk fills its
+// own buffers, and these are merged in row order with a single allocation,
+// so the results never depend on scheduling.
+//
+// Malformed cells are collected rather than reported, so that the caller
+// can word the diagnostics.  Non-negative cells become edges in row-major
+// order, which is the order the explorer numbers its edges in.
+class SpecParser
+{
+public:
+    enum Status {
+        Parsed,
+        Empty,
+        TooFewLines,
+        BadNodeNames,
+        DuplicateName,
+        ShortRow,
+    };
+
+    struct BadCell
+    {
+        int         row;
+        int         column;
+        std::string text;
+    };
+
+    SpecParser();
+
+    Status parse(const char* data, size_t size, ThreadPool* pool = nullptr);
+    void   clear();
+
+    Status status() const { return m_status; }
+
+    int nodeCount() const { return m_nodeCount; }
+    int lineCount() const { return m_lineCount; }
+    int nameCount() const { return m_nameCount; }
+
+    // Node names, given or generated; may be moved out once parsed
+    SymbolTable& names() { return m_names; }
+    const SymbolTable& names() const { return m_names; }
+
+    const std::vector<RoutingEdge>& edges() const { return m_edges; }
+    const std::vector<BadCell>& badCells() const { return m_badCells; }
+
+    // Everything after the matrix, one start/end pair per line
+    const std::vector<std::string>& queryLines() const { return m_queries; }
+
+    // Details of a DuplicateName or ShortRow failure
+    const std::string& duplicateName() const { return m_duplicate; }
+    int shortRow() const { return m_shortRow; }
+    int shortRowLength() const { return m_shortRowLength; }
+
+    // Converts a cell the way QString::toInt() would after trimming it
+    static bool parseCell(const char* begin, const char* end, int& value);
+
+    // Rows parsed per task
+    static const int RowsPerChunk = 32;
+
+private:
+    // Results for one run of rows; shortRow is -1 if they were all fine
+    struct Chunk
+    {
+        std::vector<RoutingEdge>    edges;
+        std::vector<BadCell>        badCells;
+        int                         shortRow;
+        int                         shortRowLength;
+
+        Chunk() : shortRow(-1), shortRowLength(0) {}
+    };
+
+    // Room for the header and a row per node, however large the count
+    bool hasAllRows() const
+        { return m_lineCount >= static_cast<long long>(m_nodeCount) + 2; }
+
+    void parseHeader(const char* begin, const char* end);
+    int  parseRow(int row, const char* begin, const char* end,
+        std::vector<RoutingEdge>& edges,
+        std::vector<BadCell>& badCells) const;
+    void merge(const std::vector<Chunk>& chunks, ThreadPool* pool);
+
+    static const char* findLineEnd(const char* begin, const char* end);
+
+private:
+    Status                      m_status;
+    int                         m_nodeCount;
+    int                         m_lineCount;
+    int                         m_nameCount;
+
+    SymbolTable                 m_names;
+    std::vector<RoutingEdge>    m_edges;
+    std::vector<BadCell>        m_badCells;
+    std::vector<std::string>    m_queries;
+
+    std::string                 m_duplicate;
+    int                         m_shortRow;
+    int                         m_shortRowLength;
+};
+
+
+#endif  /* !SPECPARSER_H */
@@ -0,0 +1,154 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "symboltable.h"
+
+SymbolTable::SymbolTable()
+    : m_offsets(1, 0)
+    , m_slots(16, EmptySlot)
+    , m_mask(15)
+    , m_longest(0)
+{
+}
+
+void SymbolTable::reserve(int count)
+{
+    // Keep the load factor at or below one half
+    size_t capacity = m_slots.size();
+    while (capacity < 2 * static_cast<size_t>(count)) {
+        capacity *= 2;
+    }
+
+    if (capacity != m_slots.size()) {
+        rehash(capacity);
+    }
+    m_offsets.reserve(count + 1);
+    m_hashes.reserve(count);
+}
+
+void SymbolTable::clear()
+{
+    m_pool.clear();
+    m_offsets.assign(1, 0);
+    m_hashes.clear();
+    m_slots.assign(16, EmptySlot);
+    m_mask    = 15;
+    m_longest = 0;
+}
+
+int SymbolTable::intern(const char* name, size_t length)
+{
+    size_t h    = hash(name, length);
+    size_t slot = probe(name, length, h);
+    if (m_slots[slot] != EmptySlot) {
+        return m_slots[slot];
+    }
+
+    // New symbol: append it to the pool
+    int index = size();
+    m_pool.append(name, length);
+    m_offsets.push_back(m_pool.size());
+    m_hashes.push_back(h);
+    m_slots[slot] = index;
+    m_longest     = std::max(m_longest, length);
+
+    if (2 * static_cast<size_t>(size()) > m_slots.size()) {
+        rehash(2 * m_slots.size());
+    }
+
+    return index;
+}
+
+int SymbolTable::find(const char* name, size_t length) const
+{
+    return m_slots[probe(name, length, hash(name, length))];
+}
+
+std::string SymbolTable::name(int index) const
+{
+    return m_pool.substr(m_offsets[index],
+        m_offsets[index + 1] - m_offsets[index]);
+}
+
+int SymbolTable::resolve(const std::string& token) const
+{
+    int index = find(token);
+    if (index >= 0 || token.empty()) {
+        return index;
+    }
+
+    // Fall back on a plain numeric node index
+    long long value = 0;
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (token[i] < '0' || token[i] > '9' || value >= size()) {
+            return -1;
+        }
+        value = value * 10 + (token[i] - '0');
+    }
+
+    return value < size() ? static_cast<int>(value) : -1;
+}
+
+std::string SymbolTable::defaultName(int index)
+{
+    std::string name;
+
+    // Bijective base-26, exactly like spreadsheet column names
+    for (++index; index > 0; index = (index - 1) / 26) {
+        name += static_cast<char>('A' + (index - 1) % 26);
+    }
+    std::reverse(name.begin(), name.end());
+
+    return name;
+}
+
+size_t SymbolTable::hash(const char* name, size_t length)
+{
+    // 64-bit FNV-1a
+    unsigned long long h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<unsigned char>(name[i]);
+        h *= 1099511628211ULL;
+    }
+
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+size_t SymbolTable::probe(const char* name, size_t length, size_t h) const
+{
+    for (size_t slot = h & m_mask; ; slot = (slot + 1) & m_mask) {
+        int index = m_slots[slot];
+        if (index == EmptySlot) {
+            return slot;
+        }
+
+        size_t offset = m_offsets[index];
+        if (m_hashes[index] == h &&
+                m_offsets[index + 1] - offset == length &&
+                std::memcmp(m_pool.data() + offset, name, length) == 0) {
+            return slot;
+        }
+    }
+}
+
+void SymbolTable::rehash(size_t capacity)
+{
+    m_slots.assign(capacity, EmptySlot);
+    m_mask = capacity - 1;
+
+    // Re-insert every symbol using its cached hash
+    for (int index = 0; index < size(); ++index) {
+        size_t slot = m_hashes[index] & m_mask;
+        while (m_slots[slot] != EmptySlot) {
+            slot = (slot + 1) & m_mask;
+        }
+        m_slots[slot] = index;
+    }
+}
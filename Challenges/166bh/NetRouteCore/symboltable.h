@@ -0,0 +1,70 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+// Interned node names.  Every distinct name is stored once in a single
+// character pool and given the next dense index, which is the DigraphVertex
+// of the node it names.  Lookups go through an open-addressing hash table
+// (linear probing, power-of-two capacity) so resolving a name is O(1).
+class SymbolTable
+{
+public:
+    SymbolTable();
+
+    void reserve(int count);
+    void clear();
+
+    int size() const { return static_cast<int>(m_offsets.size()) - 1; }
+
+    // Length of the longest name interned, in bytes
+    size_t longestName() const { return m_longest; }
+
+    // Returns the index of name, adding it to the table if it is new
+    int intern(const char* name, size_t length);
+    int intern(const std::string& name)
+        { return intern(name.data(), name.size()); }
+
+    // Returns the index of name, or -1 if it has never been interned
+    int find(const char* name, size_t length) const;
+    int find(const std::string& name) const
+        { return find(name.data(), name.size()); }
+
+    std::string name(int index) const;
+
+    // Resolves a start/end token: a known name, or failing that a numeric
+    // node index in [0, size()).  Returns -1 if neither applies.
+    int resolve(const std::string& token) const;
+
+    // Spreadsheet-style labels (A..Z, AA..AZ, BA..) for unnamed nodes
+    static std::string defaultName(int index);
+
+private:
+    static size_t hash(const char* name, size_t length);
+
+    size_t probe(const char* name, size_t length, size_t h) const;
+    void   rehash(size_t capacity);
+
+private:
+    enum { EmptySlot = -1 };
+
+    std::string         m_pool;
+    std::vector<size_t> m_offsets;
+    std::vector<int>    m_slots;
+    std::vector<size_t> m_hashes;
+    size_t              m_mask;
+    size_t              m_longest;
+};
+
+
+#endif  /* !SYMBOLTABLE_H */
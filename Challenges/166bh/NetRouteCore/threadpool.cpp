@@ -0,0 +1,111 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int threads /* = 0 */)
+    : m_task(nullptr)
+    , m_count(0)
+    , m_next(0)
+    , m_active(0)
+    , m_generation(0)
+    , m_stopping(false)
+{
+    if (threads <= 0) {
+        threads = idealThreadCount();
+    }
+
+    // The caller is thread 0, so only spawn the rest
+    for (int i = 1; i < threads; ++i) {
+        m_workers.push_back(std::thread(&ThreadPool::workerMain, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i].join();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const Task& task)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // Nothing to gain from waking the workers for a single item
+    if (m_workers.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(m_submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task   = &task;
+        m_count  = count;
+        m_next   = 0;
+        m_active = static_cast<int>(m_workers.size());
+        m_generation += 1;
+    }
+    m_wake.notify_all();
+
+    // Pitch in, then wait for the stragglers
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] () { return m_active == 0; });
+    m_task = nullptr;
+}
+
+int ThreadPool::idealThreadCount()
+{
+    unsigned count = std::thread::hardware_concurrency();
+    return count > 0 ? static_cast<int>(count) : 1;
+}
+
+void ThreadPool::workerMain(int thread)
+{
+    unsigned generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, generation] () {
+                return m_stopping || m_generation != generation;
+            });
+
+            if (m_stopping) {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        runTasks(thread);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_active == 0) {
+            m_finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::runTasks(int thread)
+{
+    for (int i = m_next++; i < m_count; i = m_next++) {
+        (*m_task)(i, thread);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads for data-parallel loops.  The calling thread
+// takes part in every loop as thread 0, so a pool of one thread simply runs
+// everything inline.
+class ThreadPool
+{
+public:
+    // Signature of a loop body: task(index, thread), where thread is in
+    // [0, threadCount()) and can be used to pick per-thread scratch space
+    typedef std::function<void (int, int)> Task;
+
+    // A thread count of zero means one per hardware thread
+    ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int threadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    // Runs task for every index in [0, count) and waits for all of them.
+    // Loops are not re-entrant: task must not call parallelFor itself.
+    void parallelFor(int count, const Task& task);
+
+    static int idealThreadCount();
+
+private:
+    void workerMain(int thread);
+    void runTasks(int thread);
+
+private:
+    std::vector<std::thread>    m_workers;
+
+    std::mutex                  m_submitMutex;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_wake;
+    std::condition_variable     m_finished;
+
+    const Task*                 m_task;
+    int                         m_count;
+    std::atomic<int>            m_next;
+    int                         m_active;
+    unsigned                    m_generation;
+    bool                        m_stopping;
+};
+
+
+#endif  /* !THREADPOOL_H */
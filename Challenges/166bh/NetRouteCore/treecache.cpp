@@ -0,0 +1,72 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#include "treecache.h"
+
+TreeCache::TreeCache(const RoutingGraph* graph /* = nullptr */,
+                     int capacity /* = DefaultCapacity */)
+    : m_graph(graph)
+    , m_capacity(capacity < 1 ? 1 : capacity)
+{
+}
+
+void TreeCache::setGraph(const RoutingGraph* graph)
+{
+    m_graph = graph;
+    m_trees.clear();
+}
+
+void TreeCache::setCapacity(int capacity)
+{
+    m_capacity = capacity < 1 ? 1 : capacity;
+    while (size() > m_capacity) {
+        m_trees.pop_back();
+    }
+}
+
+ShortestPathTree* TreeCache::find(int source)
+{
+    std::list<ShortestPathTree>::iterator it = m_trees.begin();
+    for (; it != m_trees.end(); ++it) {
+        if (it->source() == source) {
+            m_trees.splice(m_trees.begin(), m_trees, it);
+            return &m_trees.front();
+        }
+    }
+
+    return nullptr;
+}
+
+ShortestPathTree& TreeCache::tree(int source)
+{
+    ShortestPathTree* cached = find(source);
+    if (cached) {
+        return *cached;
+    }
+
+    // Recycle the least recently used tree once the cache is full
+    if (size() < m_capacity) {
+        m_trees.push_front(ShortestPathTree(m_graph));
+    } else {
+        m_trees.splice(m_trees.begin(), m_trees, --m_trees.end());
+    }
+
+    m_trees.front().build(source);
+    return m_trees.front();
+}
+
+void TreeCache::invalidate(int keep /* = -1 */)
+{
+    std::list<ShortestPathTree>::iterator it = m_trees.begin();
+    while (it != m_trees.end()) {
+        if (it->source() == keep) {
+            ++it;
+        } else {
+            it = m_trees.erase(it);
+        }
+    }
+}
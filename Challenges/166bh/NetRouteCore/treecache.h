@@ -0,0 +1,55 @@
+/*
+ * Copyright  2014 Kier Dugan.  All Rights Reserved.
+ *
+ * This source code is covered by the MIT licence as set out in the LICENSE
+ * file at the root of this repository.
+ */
+
+#ifndef TREECACHE_H
+#define TREECACHE_H
+
+#include <list>
+
+#include "routinggraph.h"
+#include "shortestpathtree.h"
+
+
+// Least-recently-used cache of complete shortest-path trees, one per start
+// node.  Once a start node's tree is cached, the route to any destination is
+// just a walk back through its predecessors.  When the cache is full, the
+// least recently used tree is rebuilt for the new start node in place, so
+// its arrays are not reallocated.
+class TreeCache
+{
+public:
+    enum { DefaultCapacity = 8 };
+
+    TreeCache(const RoutingGraph* graph = nullptr,
+        int capacity = DefaultCapacity);
+
+    const RoutingGraph* graph() const { return m_graph; }
+    void setGraph(const RoutingGraph* graph);
+
+    int  capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+    int  size() const { return static_cast<int>(m_trees.size()); }
+
+    // Cached tree rooted at source, or null; a hit makes it most recent
+    ShortestPathTree* find(int source);
+
+    // As find(), but builds the tree if it is not cached
+    ShortestPathTree& tree(int source);
+
+    // Drops every tree, or every tree but the one rooted at keep
+    void invalidate(int keep = -1);
+
+private:
+    const RoutingGraph*             m_graph;
+    int                             m_capacity;
+
+    // Most recently used first
+    std::list<ShortestPathTree>     m_trees;
+};
+
+
+#endif  /* !TREECACHE_H */